@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file <bench_suite.h>
+ * @brief <Microbenchmark suite of the public memory, data and stats functions>
+ *
+ * <This file contains the declaration of the microbenchmark suite run by the
+ *  "bench" target of the HOST build (see bench.c). Every public function of
+ *  memory.h, data.h and stats.h is one or more cases, swept over sizes and,
+ *  for the byte copy functions, source / destination alignment and overlap.
+ *
+ *  Each case is timed in samples of a batch of calls; the batch is doubled
+ *  until a sample takes BENCH_SAMPLE_NS. Samples are taken until the median
+ *  has moved by less than BENCH_STABLE_PERCENT for BENCH_STABLE_SAMPLES samples
+ *  in a row (at least BENCH_MIN_SAMPLES, at most BENCH_MAX_SAMPLES or
+ *  BENCH_CASE_NS). The median ns per call, bytes/s and cycles per byte are
+ *  reported. Time comes from clock_gettime (CLOCK_MONOTONIC), cycles from the
+ *  time stamp counter (rdtsc) on x86 - constant rate, so these are reference
+ *  cycles - and are left out on other CPUs.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#ifndef __BENCH_SUITE_H__
+#define __BENCH_SUITE_H__
+
+#define BENCH_SAMPLE_NS       (50000.0)       // min time of one sample (batch of calls)
+#define BENCH_CASE_NS         (250000000.0)   // max time spent sampling one case
+#define BENCH_MIN_SAMPLES     (9)
+#define BENCH_MAX_SAMPLES     (99)
+#define BENCH_STABLE_SAMPLES  (5)             // stable medians in a row to stop
+#define BENCH_STABLE_PERCENT  (1.0)           // max move of a stable median
+#define BENCH_SUITE_MAX_BYTES (4UL*1024UL*1024UL)  // largest buffer of the size sweeps
+
+/**
+ * @brief <Output format of bench_suite>
+ *
+ * <BENCH_TEXT : table for the screen
+ *  BENCH_CSV  : one header line, then one line per case
+ *  BENCH_JSON : one object {"timer", "cycles", "isa", "results": [one object per case]}>
+ */
+typedef enum {
+    BENCH_TEXT,
+    BENCH_CSV,
+    BENCH_JSON
+} bench_format_t;
+
+
+
+int bench_suite(bench_format_t format, const char * filter);
+/**
+ * @brief <Runs the microbenchmark suite and prints the results to stdout>
+ *
+ * <Cases whose function name does not contain filter are skipped, so
+ *  filter "my_mem" runs my_memmove, my_memmove_clear, my_memcopy, ...
+ *  Output of the print functions under test goes to /dev/null.>
+ *
+ * @param <format>        <output format>
+ * @param <filter>        <part of the function names to run, NULL for all>
+ *
+ * @return <0 on success, 1 if out of memory >
+ */
+
+
+
+#endif /* __BENCH_SUITE_H__ */
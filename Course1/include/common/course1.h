@@ -25,11 +25,49 @@
 #define MEM_SET_SIZE_B  (32)
 #define MEM_SET_SIZE_W  (8)
 #define MEM_ZERO_LENGTH (16)
+#define PATTERN_FILL_LENGTH (19)      // odd - ends inside a pattern repeat
+#define COURSE1_ARENA_SIZE_W (64)
+#define ARENA_TEST_SIZE_D   (8)       // 8 byte words of the arena under test
+#define ARENA_TEST_POOL_W   (4)       // words per block of the pool in front of it
+#define POOL_TEST_SMALL_W   (2)       // size classes of test_pool
+#define POOL_TEST_LARGE_W   (8)
+#define POOL_TEST_BLOCKS    (4)
+#define SORT_SET_SIZE       (1000)    // counting sort path of sort_array
+#define MEDIAN_SET_SIZE_MAX (40)
+#define MEDIAN_ROUNDS       (64)
+#define PARALLEL_MAX_THREADS (7)
+#define PSORT_THREADS       (4)
+#define DISPATCH_SHIFT_B    (8)       // room below the source for moves downwards
+#if defined (HOST)
+#define MEDIAN_SHAPE_SIZE_MAX (1001)  // sorted / reversed / equal / organ pipe sets
+#define STREAM_SET_SIZE     (10000)
+#define PARALLEL_SET_SIZE   (STATS_PARALLEL_MIN_LENGTH + 4097)  // threaded, short last chunk
+#define PSORT_SET_SIZE      (300000)  // several merge sort leaves
+#define DISPATCH_SET_SIZE_B (1024)    // two halves - source and destination of 255 byte moves
+#else
+/* MSP432 - 64 KB RAM holds all static test sets at once */
+#define MEDIAN_SHAPE_SIZE_MAX (301)
+#define STREAM_SET_SIZE     (1024)
+#define PARALLEL_SET_SIZE   (STREAM_SET_SIZE)     // single threaded anyway
+#define PSORT_SET_SIZE      (256)     // single threaded anyway
+#define DISPATCH_SET_SIZE_B (544)     // halves of 8 + 3 + 255 bytes and a little more
+#endif
+#define TRACE_TEST_TEXT_SIZE (128)
+#if defined (VERBOSE) && defined (HOST)
+#define PRINT_TEST_SET_SIZE (2000)    // print_array text - 2 full print buffers and a rest
+#define PRINT_TEST_TEXT_SIZE (12288)
+#else
+#define PRINT_TEST_SET_SIZE (16)      // print_array prints nothing
+#define PRINT_TEST_TEXT_SIZE (256)
+#endif
+#define ITOA_BATCH_LENGTH   (8)
+#define ITOA_BATCH_STRING_B (36)      // base 2 with prefix and '\0'
+#define ITOA_BATCH_SIZE_B   (ITOA_BATCH_LENGTH * ITOA_BATCH_STRING_B)
 
 #define TEST_MEMMOVE_LENGTH (16)
 #define TEST_ERROR          (1)
 #define TEST_NO_ERROR       (0)
-#define TESTCOUNT           (8)
+#define TESTCOUNT           (25)
 #define BASE_16             (16)
 #define BASE_10             (10)
 /**
@@ -63,6 +101,28 @@ int8_t test_data1();
  */
 int8_t test_data2();
 
+/**
+ * @brief function to test the batch integer to ascii conversion
+ * 
+ * This function converts an array in several bases with my_itoa_batch. Each
+ * packed string must match my_itoa at its offset. A buffer that is too small,
+ * bad arguments and an empty batch must be told apart.
+ *
+ * @return void
+ */
+int8_t test_itoa_batch();
+
+/**
+ * @brief function to test the checked string to integer conversion
+ * 
+ * This function runs my_atoi_parse over a table of strings: the int32_t limits
+ * and one past them, prefixes, stray characters, empty strings and bad bases.
+ * The value, the characters consumed and the overflow flag must all match.
+ *
+ * @return void
+ */
+int8_t test_atoi_parse();
+
 /**
  * @brief function to test the non-overlapped memmove operation
  * 
@@ -98,6 +158,17 @@ int8_t test_memmove2();
  */
 int8_t test_memmove3();
 
+/**
+ * @brief function to test the memmove and clear functionality
+ * 
+ * This function calls my_memmove_clear for sets which do not overlap, and for
+ * sets where the destination lies above or below the source. The moved bytes
+ * must match and source bytes outside the destination must be zero.
+ *
+ * @return void
+ */
+int8_t test_memmove_clear();
+
 /**
  * @brief function to test the memcopy functionality
  * 
@@ -128,5 +199,167 @@ int8_t test_memset();
  */
 int8_t test_reverse();
 
+/**
+ * @brief function to test the arena allocator
+ * 
+ * This function checks arena_init alignment, bump allocation until the arena
+ * is full, arena_reset and arena_create / arena_destroy. Then it checks the
+ * order reserve_words tries pools, arena and heap in, and that free_words
+ * still hands blocks back after their pool and arena are uninstalled.
+ *
+ * @return void
+ */
+int8_t test_arena();
+
+/**
+ * @brief function to test the fixed size block pools
+ * 
+ * This function checks that pool_init refuses bad storage, hands out every
+ * block once and tracks the high water mark. Double frees and foreign pointers
+ * must be refused. Installed as size classes, a full pool must fall through to
+ * the next pool and then to the arena.
+ *
+ * @return void
+ */
+int8_t test_pool();
+
+/**
+ * @brief function to test the sort_array functionality
+ * 
+ * This function sorts random data sets of several lengths, with many duplicates
+ * and both ends of the value range. Each one must come back largest first and
+ * hold the same items.
+ *
+ * @return void
+ */
+int8_t test_sort_array();
+
+/**
+ * @brief function to test the median functionality
+ * 
+ * This function fills data sets of random length and content and checks
+ * find_median and find_median_i32 against the middle item(s) of a copy sorted
+ * with a reference insertion sort. The data sets must be left unchanged.
+ * An arena too small for the copy must be reported as an error.
+ *
+ * @return void
+ */
+int8_t test_median();
+
+/**
+ * @brief function to test the rank and percentile queries
+ * 
+ * This function checks stats_value_at_rank and stats_percentile of a shuffled
+ * data set against its sorted copy. It also covers ranks past the end, one item,
+ * no items, and find_median for odd and even counts.
+ *
+ * @return void
+ */
+int8_t test_rank_percentile();
+
+/**
+ * @brief function to test the streaming statistics accumulator
+ * 
+ * This function pushes a random data set item by item into one accumulator
+ * and in two blocks into two others which are then merged. Both must report
+ * the same statistics as compute_statistics on the whole data set.
+ *
+ * @return void
+ */
+int8_t test_stats_stream();
+
+/**
+ * @brief function to test the multithreaded statistics
+ * 
+ * This function runs compute_statistics_parallel without a pool and twice on
+ * task pools of 1 to 7 threads on a random data set, each must report the
+ * same statistics as compute_statistics. A set shorter than
+ * STATS_PARALLEL_MIN_LENGTH must stay single threaded on a 4 thread pool.
+ *
+ * @return void
+ */
+int8_t test_stats_parallel();
+
+/**
+ * @brief function to test the statistics of the other data types
+ * 
+ * This function fills random data sets of each type (uint8, int16, uint16,
+ * int32, float, double) and checks stats_compute_* against statistics worked
+ * out from a copy sorted with a reference insertion sort.
+ *
+ * @return void
+ */
+int8_t test_stats_generic();
+
+/**
+ * @brief function to test the select (nth element) functionality
+ * 
+ * This function runs stats_select_* on random unsigned (uint8, uint16) and
+ * floating point (float, double) data sets, the latter mixed with -0.0 and
+ * +0.0, and checks the item at a random rank and the order around it against
+ * a copy sorted with a reference insertion sort.
+ *
+ * @return void
+ */
+int8_t test_stats_select();
+
+/**
+ * @brief function to test the radix sort functionality
+ * 
+ * This function sorts random data sets of every key type with stats_sort_*
+ * in ascending and descending order and compares them with a copy sorted by a
+ * reference insertion sort.
+ *
+ * @return void
+ */
+int8_t test_radix_sort();
+
+/**
+ * @brief function to test the parallel sort functionality
+ * 
+ * This function sorts a random data set with sort_parallel_i32 on a task pool
+ * in ascending and descending order and compares it with stats_sort_i32 of a
+ * copy.
+ *
+ * @return void
+ */
+int8_t test_parallel_sort();
+
+/**
+ * @brief function to test the run time selected SIMD kernels
+ * 
+ * This function binds the kernels to every ISA level up to cpu_isa() in turn
+ * (cpu_isa_install) and checks my_memmove (with and without overlap),
+ * my_memset_pattern, my_reverse and find_min_max_sum against plain byte loops
+ * for lengths around the vector sizes and unaligned start addresses. It then
+ * fills the binder table and checks that cpu_dispatch_register reports it.
+ *
+ * @return void
+ */
+int8_t test_cpu_dispatch();
+
+/**
+ * @brief function to test the deferred trace buffer
+ * 
+ * This function captures trace output through a sink and checks that every
+ * argument is formatted as its conversion asks. A full ring must drop new
+ * records, and the next flush must report them.
+ *
+ * @return void
+ */
+int8_t test_trace();
+
+/**
+ * @brief function to test the buffered print output
+ * 
+ * This function installs a capturing writer (stats_writer_install) and checks
+ * the text of print_statistics_result for a data set length above INT32_MAX
+ * and, in VERBOSE HOST builds, of print_array for every stats_print_install
+ * mode, with output longer than STATS_PRINT_BUFFER_SIZE.
+ *
+ * @return void
+ */
+int8_t test_stats_print();
+
 #endif /* __COURSE1_H__ */
 
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file <cpu_dispatch.h>
+ * @brief <Run time selection of the SIMD kernels (x86 HOST)>
+ *
+ * <This file contains the declarations of the CPU feature dispatch. One binary
+ *  carries scalar, SSE2, SSSE3, AVX2 and AVX-512 kernels (compiled with GCC
+ *  target attributes, so no -m flags are needed); at load time the CPU is
+ *  checked once (cpuid through __builtin_cpu_supports) and every module binds
+ *  its kernel pointers to the widest supported ISA level.
+ *
+ *  The environment variable CPU_ISA_ENV (COURSE1_ISA=scalar, sse2, ssse3, avx2
+ *  or avx512) lowers the level for testing; levels above what the CPU supports
+ *  are capped. Other platforms always run at CPU_ISA_SCALAR (their own kernels,
+ *  e.g. the Cortex-M4 SIMD instructions on MSP432, are chosen at compile time).>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#ifndef __CPU_DISPATCH_H__
+#define __CPU_DISPATCH_H__
+
+#if defined (HOST) && (defined (__x86_64__) || defined (__i386__))
+#define CPU_DISPATCH_X86                    // kernels picked at run time
+#endif
+
+#define CPU_ISA_ENV               "COURSE1_ISA"
+#define CPU_DISPATCH_MAX_BINDERS  (8)       // modules with dispatched kernels
+
+/**
+ * @brief <ISA levels, each includes the ones before it>
+ *
+ * <CPU_ISA_AVX512 needs AVX-512F and AVX-512BW.>
+ */
+typedef enum {
+    CPU_ISA_SCALAR,
+    CPU_ISA_SSE2,
+    CPU_ISA_SSSE3,
+    CPU_ISA_AVX2,
+    CPU_ISA_AVX512,
+    CPU_ISA_COUNT
+} cpu_isa_t;
+
+/**
+ * @brief <Module function which binds its kernels to an ISA level>
+ */
+typedef void (*cpu_bind_fn_t)(cpu_isa_t isa);
+
+
+
+cpu_isa_t cpu_isa_supported(void);
+/**
+ * @brief <Returns the widest ISA level supported by the CPU (and OS)>
+ *
+ * @return <ISA level, CPU_ISA_SCALAR on platforms without dispatch >
+ */
+
+
+
+cpu_isa_t cpu_isa(void);
+/**
+ * @brief <Returns the ISA level the kernels are bound to>
+ *
+ * <On the first call this is cpu_isa_supported, lowered by CPU_ISA_ENV if set.
+ *  An unknown CPU_ISA_ENV value is ignored and reported with TRACE.>
+ *
+ * @return <ISA level in use >
+ */
+
+
+
+cpu_isa_t cpu_isa_install(cpu_isa_t isa);
+/**
+ * @brief <Rebinds the kernels of every registered module to an ISA level>
+ *
+ * <Levels above cpu_isa_supported are capped. Meant for tests and benchmarks:
+ *  no other thread may run a dispatched function during the call.>
+ *
+ * @param <isa>           <ISA level to use>
+ *
+ * @return <previous ISA level >
+ */
+
+
+
+int cpu_dispatch_register(cpu_bind_fn_t bind);
+/**
+ * @brief <Registers the bind function of a module and calls it with cpu_isa()>
+ *
+ * <Modules call this from a constructor, so their kernels are bound before
+ *  main. At most CPU_DISPATCH_MAX_BINDERS modules; past that the module is
+ *  still bound to cpu_isa() once, but cpu_isa_install no longer rebinds it.>
+ *
+ * @param <bind>          <bind function of the module>
+ *
+ * @return <1 if registered, 0 if the table is full >
+ */
+
+
+
+const char * cpu_isa_name(cpu_isa_t isa);
+/**
+ * @brief <Returns the name of an ISA level as used by CPU_ISA_ENV>
+ *
+ * @param <isa>           <ISA level>
+ *
+ * @return <name, e.g. "avx2" ("?" for unknown levels) >
+ */
+
+
+
+#endif /* __CPU_DISPATCH_H__ */
@@ -17,6 +17,8 @@
 #include <stdint.h>
 #include "memory.h"
 
+#define ITOA_BATCH_ERROR  (SIZE_MAX)      // my_itoa_batch: bad base or arguments, out too small
+
 
 /*---------------------------------  my_itoa  -----------------------------------------------*
  * Integer-to-ASCII needs to convert data from a standard integer type into an ASCII string.
@@ -32,18 +34,53 @@
  * terminator).
  *
  * This function needs to handle signed data.
+ * Bases 2, 8 and 16 print the 32-bit two's complement pattern with a "0b", "0c" or "0x"
+ * prefix, all other bases print a '-' before the digits of a negative number.
+ * The digits are written straight into ptr, no heap memory is used.
  *
  * @param data    : int32_t integer to be converted to ascii
  * @param ptr     : uint8_t * - Pointer to buffer which stores the ascii char
  * @param base    : uint32_t base - target base
  *
  * @return        : unsigned 8byte integer which stores length of char in buffer
+ *                  (0 if base is outside 2 to 16)
  *--------------------------------------------------------------------------------------------*/
 
 uint8_t my_itoa(int32_t data, uint8_t * ptr, uint32_t base);
 
 
 
+/*---------------------------------  my_itoa_batch  -----------------------------------------*
+ *
+ * Integer-to-ASCII of an array. Each integer is converted as by my_itoa and the strings
+ * are packed one after the other into out, each ended by '\0' (the delimiter);
+ * offsets[i] is the index in out where string i starts, so its length (without '\0')
+ * is offsets[i + 1] - offsets[i] - 1, or return value - offsets[n - 1] - 1 for the last.
+ *
+ * All digits are counted before anything is written, so the exact size is known up
+ * front: with out = NULL nothing is written and the size needed is returned (offsets
+ * are filled if not NULL). If cap is too small nothing is written to out.
+ * n = 0 is no error: there is nothing to write and 0 bytes are used.
+ *
+ * @param in      : const int32_t * - integers to be converted
+ * @param n       : size_t          - no of integers
+ * @param base    : uint32_t        - target base (2 to 16)
+ * @param out     : uint8_t *       - buffer for the strings, NULL to only get the size
+ * @param cap     : size_t          - size of out in bytes
+ * @param offsets : uint32_t *      - n offsets into out (may be NULL if out is NULL
+ *                                    or n = 0)
+ *
+ * @return        : size_t          - bytes used in out (all '\0' included),
+ *                                    ITOA_BATCH_ERROR if base is outside 2 to 16,
+ *                                    offsets is NULL, an offset passes 4 GiB or out
+ *                                    is too small
+ *--------------------------------------------------------------------------------------------*/
+
+size_t my_itoa_batch(const int32_t * in, size_t n, uint32_t base,
+                     uint8_t * out, size_t cap, uint32_t * offsets);
+
+
+
 
 
 
@@ -59,6 +96,9 @@ uint8_t my_itoa(int32_t data, uint8_t * ptr, uint32_t base);
  *
  * This function needs to handle signed data.
  *
+ * The string is parsed up to the first non-digit (see my_atoi_parse), so digits is
+ * no longer needed and is ignored.
+ *
  * @param ptr     : uint8_t * - Pointer to buffer which stores the ascii char
  * @param digits  : uint8_t   - integer value of no of ascii digits in buffer
  * @param base    : uint32_t  - target base
@@ -70,4 +110,27 @@ int32_t my_atoi(uint8_t * ptr, uint8_t digits, uint32_t base);
 
 
 
+/*---------------------------------  my_atoi_parse  -----------------------------------------*
+ *
+ * ASCII-to-Integer parser which finds the end of the number itself.
+ * Accepts an optional '-' and, for bases 2, 8 and 16, the "0b", "0c" and "0x" prefixes
+ * written by my_itoa, then reads digits ('0'-'9', 'A'-'F' or 'a'-'f') until the first
+ * char which is not a digit of the base.
+ * Bases 2, 8 and 16 take the digits as a 32-bit two's complement pattern (0 to 0xFFFFFFFF),
+ * all other bases as a signed value (INT32_MIN to INT32_MAX).
+ *
+ * @param ptr      : const uint8_t * - Pointer to buffer which stores the ascii char
+ * @param base     : uint32_t        - target base (2 to 16)
+ * @param value    : int32_t *       - converted value, INT32_MIN / INT32_MAX on overflow
+ * @param overflow : uint8_t *       - set to 1 if the number does not fit in 32 bits,
+ *                                     else 0 (may be NULL)
+ *
+ * @return         : size_t          - number of bytes consumed (sign, prefix and digits),
+ *                                     0 if no digit was found or base is not supported
+ *--------------------------------------------------------------------------------------------*/
+
+size_t my_atoi_parse(const uint8_t * ptr, uint32_t base, int32_t * value, uint8_t * overflow);
+
+
+
 #endif //__DATA_H__
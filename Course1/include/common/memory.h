@@ -107,6 +107,8 @@ void clear_all(char * ptr, unsigned int size);
  * it checks for overlap of source and destination by checking for 
  * contiguous available space to store data and avoid data corruption
  *
+ * The source data is left unchanged.
+ *
  * @param src    : Pointer to data array
  * @param dst    : Pointer to data array
  * @param length : Number of elements to set to zero
@@ -117,6 +119,22 @@ uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length);
 
 
 
+/*-------------------------- my_memmove_clear --------------------------*
+ *
+ * This function moves data from the source to the destination like
+ * my_memmove and then sets to zero every source byte which was not
+ * overwritten by the destination (the non-overlapping part of src).
+ *
+ * @param src    : Pointer to data array
+ * @param dst    : Pointer to data array
+ * @param length : Number of bytes to move
+ *
+ * @return : Pointer of type(int8_t).
+ *----------------------------------------------------------------------*/
+uint8_t * my_memmove_clear(uint8_t * src, uint8_t * dst, size_t length);
+
+
+
 /*----------------------------- my_memcopy -----------------------------*
  *
  * This function takes two byte pointers (one source and one destination)
@@ -165,6 +183,26 @@ uint8_t * my_memzero(uint8_t * src, size_t length);
 
 
 
+/*---------------------- my_memset_pattern -----------------------*
+ *
+ * This should take a pointer to a memory location, a length in
+ * bytes and fill the memory with a repeating pattern of 1, 2, 4
+ * or 8 bytes. The first pattern byte goes to the start address:
+ * src[i] = pattern[i % pattern_len]
+ *
+ * @param src         : Pointer to data array
+ * @param length      : Number of bytes to fill
+ * @param pattern     : Pointer to the pattern bytes
+ * @param pattern_len : Number of bytes in pattern (1, 2, 4 or 8)
+ *
+ * @return : Pointer of type(int8_t), NULL if pattern_len is not
+ *           supported (memory is left unchanged).
+ *----------------------------------------------------------------*/
+uint8_t * my_memset_pattern(uint8_t * src, size_t length,
+                            const uint8_t * pattern, size_t pattern_len);
+
+
+
 /*------------------ my_reverse -----------------------*
  *
  * This should take a pointer to a memory location 
@@ -201,6 +239,9 @@ uint8_t * my_reverse(uint8_t * src, size_t length);
  * dynamic memory by using the malloc function and
  * casting to ptr to the data type
  *
+ * If an arena has been installed (arena_install)
+ * the words are taken from the arena instead.
+ *
  * @param length : Number of elements in data array
  *
  * @return : Pointer of type(int32_t).
@@ -215,6 +256,12 @@ int32_t * reserve_words(size_t length);
  * memory allocation by providing the 
  * pointer src to the function
  *
+ * Pointers into the installed arena
+ * are ignored (see arena_reset).
+ * Blocks of an arena or pools which
+ * were uninstalled since are still
+ * recognised, see arena_install.
+ *
  * @param src : Pointer to data on heap
  *
  * @return : void
@@ -223,15 +270,243 @@ void free_words(uint32_t * src);
 
 
 
+/*---------------------------- mem_arena_t ----------------------------*
+ *
+ * Linear (bump) allocator. Blocks are handed out from one buffer in
+ * order and are all released together by arena_reset.
+ *
+ * -> base   : aligned start of the arena buffer
+ * -> size   : usable bytes from base
+ * -> offset : bytes handed out so far
+ * -> heap   : malloc block owned by the arena (NULL for caller buffer)
+ *----------------------------------------------------------------------*/
+#define MEM_ARENA_ALIGN  (8)                 // block alignment in bytes
 
+typedef struct {
+    uint8_t * base;
+    size_t    size;
+    size_t    offset;
+    uint8_t * heap;
+} mem_arena_t;
 
 
 
+/*-------------- arena_init -----------------------*
+ *
+ * This should set up an arena on a caller supplied
+ * buffer (e.g. a static array on the MSP432).
+ *
+ * @param arena  : Pointer to arena to set up
+ * @param buffer : Pointer to backing buffer
+ * @param size   : Size of buffer in bytes
+ *
+ * @return : Pointer to arena, NULL on bad input.
+ *-------------------------------------------------*/
+mem_arena_t * arena_init(mem_arena_t * arena, uint8_t * buffer, size_t size);
+
+
+
+/*-------------- arena_create ---------------------*
+ *
+ * This should set up an arena on a single malloc
+ * block of at least size bytes.
+ *
+ * @param arena  : Pointer to arena to set up
+ * @param size   : Usable size in bytes
+ *
+ * @return : Pointer to arena, NULL if malloc fails.
+ *-------------------------------------------------*/
+mem_arena_t * arena_create(mem_arena_t * arena, size_t size);
+
+
+
+/*-------------- arena_destroy --------------------*
+ *
+ * This should release the malloc block of an arena
+ * made by arena_create. The arena is uninstalled
+ * if it is the current arena.
+ *
+ * @param arena  : Pointer to arena
+ *
+ * @return : void
+ *-------------------------------------------------*/
+void arena_destroy(mem_arena_t * arena);
+
 
 
+/*-------------- arena_reserve_words --------------*
+ *
+ * This should allocate a block of words from the
+ * arena, aligned to MEM_ARENA_ALIGN bytes.
+ *
+ * @param arena  : Pointer to arena
+ * @param length : Number of words to allocate
+ *
+ * @return : Pointer of type(int32_t), NULL if the
+ *           arena has no room left.
+ *-------------------------------------------------*/
+int32_t * arena_reserve_words(mem_arena_t * arena, size_t length);
 
 
 
+/*-------------- arena_reset ----------------------*
+ *
+ * This should release every block of the arena in
+ * one step (O(1)).
+ *
+ * @param arena  : Pointer to arena
+ *
+ * @return : void
+ *-------------------------------------------------*/
+void arena_reset(mem_arena_t * arena);
+
+
+
+/*-------------- arena_install --------------------*
+ *
+ * This should make reserve_words allocate from the
+ * given arena. NULL goes back to malloc.
+ *
+ * An arena uninstalled while reserve_words blocks
+ * of it are live is retired, so free_words does
+ * not hand them to free(). One arena can be retired
+ * at a time: uninstall a second arena with live
+ * blocks and the assert fails. The retired arena
+ * is dropped when its last block is freed or it
+ * is reset, destroyed or installed again.
+ *
+ * @param arena  : Pointer to arena or NULL
+ *
+ * @return : Previously installed arena (or NULL).
+ *-------------------------------------------------*/
+mem_arena_t * arena_install(mem_arena_t * arena);
+
+
+
+/*---------------------------- mem_pool_t -----------------------------*
+ *
+ * Fixed size block pool. Blocks of one size class are carved from
+ * caller supplied (e.g. static) storage and kept on a singly linked
+ * free list, so reserve and release are O(1) and need no heap. A bit
+ * per block, kept in the storage after the last block, marks the
+ * blocks handed out so a double free is found in O(1) too.
+ *
+ * -> storage     : start of pool storage (MEM_ARENA_ALIGN aligned)
+ * -> block_words : words per block requested
+ * -> block_bytes : bytes per block after alignment
+ * -> block_count : number of blocks in the pool
+ * -> free_list   : first free block
+ * -> in_use_map  : one bit per block, set while the block is handed out
+ * -> in_use      : blocks currently handed out
+ * -> high_water  : largest in_use seen since pool_init
+ *
+ * MEM_POOL_STORAGE_BYTES gives the storage size for a pool, e.g.
+ *   static uint64_t storage[MEM_POOL_STORAGE_BYTES(8, 16) / sizeof(uint64_t)];
+ *----------------------------------------------------------------------*/
+#define MEM_POOL_BLOCK_BYTES(words)   \
+    ((((words) * sizeof(int32_t)) + (MEM_ARENA_ALIGN - 1)) & ~(size_t)(MEM_ARENA_ALIGN - 1))
+#define MEM_POOL_MAP_BYTES(count)   ((((count) + 63) / 64) * sizeof(uint64_t))
+#define MEM_POOL_STORAGE_BYTES(words, count)   \
+    ((MEM_POOL_BLOCK_BYTES(words) * (count)) + MEM_POOL_MAP_BYTES(count))
+
+typedef struct mem_pool_block {
+    struct mem_pool_block * next;
+} mem_pool_block_t;
+
+typedef struct {
+    uint8_t *          storage;
+    size_t             block_words;
+    size_t             block_bytes;
+    size_t             block_count;
+    mem_pool_block_t * free_list;
+    uint8_t *          in_use_map;
+    size_t             in_use;
+    size_t             high_water;
+} mem_pool_t;
+
+
+
+/*-------------- pool_init ------------------------*
+ *
+ * This should set up a pool on caller supplied
+ * storage and put every block on the free list.
+ * The storage also holds the in use bitmap, see
+ * MEM_POOL_STORAGE_BYTES.
+ *
+ * @param pool         : Pointer to pool to set up
+ * @param storage      : Pointer to block storage
+ * @param storage_size : Size of storage in bytes
+ * @param block_words  : Words per block
+ * @param block_count  : Number of blocks
+ *
+ * @return : Pointer to pool, NULL if the storage is
+ *           missing, unaligned or too small.
+ *-------------------------------------------------*/
+mem_pool_t * pool_init(mem_pool_t * pool, uint8_t * storage, size_t storage_size,
+                       size_t block_words, size_t block_count);
+
+
+
+/*-------------- pool_reserve ---------------------*
+ *
+ * This should take one block from the pool.
+ *
+ * @param pool : Pointer to pool
+ *
+ * @return : Pointer of type(int32_t), NULL if the
+ *           pool is empty.
+ *-------------------------------------------------*/
+int32_t * pool_reserve(mem_pool_t * pool);
+
+
+
+/*-------------- pool_release ---------------------*
+ *
+ * This should give a block back to its pool.
+ * Pointers which are not a block of the pool in
+ * use (outside it, inside a block, already free)
+ * are refused and the pool is left unchanged.
+ *
+ * @param pool : Pointer to pool
+ * @param src  : Pointer to block from pool_reserve
+ *
+ * @return : 1 if released, 0 if refused.
+ *-------------------------------------------------*/
+uint8_t pool_release(mem_pool_t * pool, void * src);
+
+
+
+/*-------------- pool_owns ------------------------*
+ *
+ * This should check if a pointer lies in the pool
+ * storage.
+ *
+ * @param pool : Pointer to pool
+ * @param src  : Pointer to check
+ *
+ * @return : 1 if src belongs to pool, else 0.
+ *-------------------------------------------------*/
+uint8_t pool_owns(const mem_pool_t * pool, const void * src);
+
+
+
+/*-------------- pool_install ---------------------*
+ *
+ * This should make reserve_words / free_words use
+ * an array of pools as size classes. The array is
+ * searched in order, so sort it by block_words.
+ * Requests no pool can serve fall through to the
+ * installed arena or malloc. NULL / 0 uninstalls.
+ * Pools with live reserve_words blocks are retired
+ * on uninstall as arenas are (see arena_install);
+ * keep them alive until those blocks are freed.
+ *
+ * @param pools      : Pointer to array of pools
+ * @param pool_count : Number of pools in array
+ *
+ * @return : void
+ *-------------------------------------------------*/
+void pool_install(mem_pool_t * pools, size_t pool_count);
 
 
 
@@ -22,18 +22,108 @@
 #ifndef __STATS_H__
 #define __STATS_H__
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* Add Your Declarations and Function Comments here */
 
+#define STATS_BUCKETS            (256)   // possible values of an unsigned char item
+#define STATS_SMALL_SORT_LENGTH  (32)    // sort_array uses insertion sort up to this length
+#define STATS_BLOCK_LENGTH       (4096)  // stats_push_block exact integer chunk (no overflow)
+#define STATS_PRINT_BUFFER_SIZE  (4096)  // print output is written in pieces of this size
+#define STATS_PRINT_COLUMNS      (10)    // default items per row of print_array
+
+/**
+ * @brief <Minimum, maximum and sum of a data set, filled by find_min_max_sum>
+ */
+typedef struct {
+    unsigned char      minimum;
+    unsigned char      maximum;
+    unsigned long long sum;
+} stats_minmaxsum_t;
+
+/**
+ * @brief <Statistics of a data set, filled by compute_statistics>
+ *
+ * <count     : no of items in data set
+ *  sum       : sum of all items
+ *  minimum   : smallest item
+ *  maximum   : largest item
+ *  mean      : sum / count (integer part)
+ *  median    : middle item, or mean of the two middle items for an even count
+ *  variance  : population variance (sum of squared deviations / count)
+ *  histogram : no of items holding each value 0 - 255>
+ */
+typedef struct {
+    unsigned long      count;
+    unsigned long long sum;
+    unsigned char      minimum;
+    unsigned char      maximum;
+    unsigned long      mean;
+    unsigned char      median;
+    double             variance;
+    unsigned long      histogram[STATS_BUCKETS];
+} stats_result_t;
+
+/**
+ * @brief <What print_array prints, see stats_print_install>
+ *
+ * <STATS_PRINT_ALL     : every item
+ *  STATS_PRINT_SUMMARY : only the no of items
+ *  STATS_PRINT_SAMPLED : about sample_count items at an even stride>
+ */
+typedef enum {
+    STATS_PRINT_ALL,
+    STATS_PRINT_SUMMARY,
+    STATS_PRINT_SAMPLED
+} stats_print_mode_t;
+
+/**
+ * @brief <Options of print_array, see stats_print_install>
+ *
+ * <mode         : what to print (stats_print_mode_t)
+ *  columns      : items per row, 0 for STATS_PRINT_COLUMNS
+ *  sample_count : items printed in mode STATS_PRINT_SAMPLED>
+ */
+typedef struct {
+    stats_print_mode_t mode;
+    unsigned int       columns;
+    unsigned long      sample_count;
+} stats_print_options_t;
+
+/**
+ * @brief <Receives the text of the print functions (length bytes, no 0 at the end)>
+ */
+typedef void (*stats_writer_t)(const char *text, size_t length);
+
+/**
+ * @brief <Streaming statistics accumulator, see stats_init>
+ *
+ * <count     : no of items pushed
+ *  sum       : sum of all items pushed
+ *  minimum   : smallest item (0xFF while empty)
+ *  maximum   : largest item (0x00 while empty)
+ *  mean      : running mean (Welford)
+ *  m2        : running sum of squared deviations from the mean (Welford)
+ *  histogram : no of items pushed holding each value 0 - 255>
+ */
+typedef struct {
+    unsigned long      count;
+    unsigned long long sum;
+    unsigned char      minimum;
+    unsigned char      maximum;
+    double             mean;
+    double             m2;
+    unsigned long      histogram[STATS_BUCKETS];
+} stats_acc_t;
+
  
 void print_statistics(unsigned char *dataSet, unsigned long data_length); 
 /**
  * @brief <A function that prints the statistics of an array including minimum, maximum, mean, and  median.>
  *
- * <This function executes the following functions to obtain statistics data
- *       find_minimum(dataSet, data_length)
- *       find_maximum(dataSet, data_length)
- *       find_mean(dataSet, data_length)
- *       find_median(dataSet, data_length)
+ * <This function obtains the statistics data with one compute_statistics call
+ *  (single pass, the data set is not sorted or modified).
  * 
  *  The statistics data obtained are printed to screen.>
  *
@@ -45,11 +135,187 @@ void print_statistics(unsigned char *dataSet, unsigned long data_length);
  */
 
 
+void print_statistics_result(unsigned char *dataSet, unsigned long data_length,
+                             const stats_result_t *result);
+/**
+ * @brief <Prints the data array and statistics already computed for it>
+ *
+ * <This function prints in the format of print_statistics, for statistics that
+ *  come from elsewhere (e.g. compute_statistics_parallel or stats_snapshot).
+ *  The whole report goes out with one fwrite (more only for long arrays).>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <result>        <statistics of the data set>
+ *
+ * @return <void : prints to screen >
+ */
+
+
+
+void compute_statistics(const unsigned char *dataSet, unsigned long data_length,
+                        stats_result_t *result);
+/**
+ * @brief <Computes all statistics of a data set in a single pass>
+ *
+ * <This function reads the data set once and collects minimum, maximum, sum and a
+ *  256 bin histogram. Mean is derived from the sum, median and variance from the
+ *  histogram, so the data set is neither sorted nor modified.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <result>        <pointer to statistics to fill>
+ *
+ * @return <void : results in *result >
+ */
+
+
+
+void stats_init(stats_acc_t *acc);
+/**
+ * @brief <Empties a streaming statistics accumulator>
+ *
+ * <An accumulator collects the statistics of data which arrives in pieces (no
+ *  need to keep the whole data set) in constant memory. Feed it with stats_push
+ *  and stats_push_block, combine accumulators with stats_merge and read the
+ *  statistics with stats_snapshot at any time.>
+ *
+ * @param <acc>           <pointer to accumulator>
+ *
+ * @return <void >
+ */
+
+
+
+void stats_push(stats_acc_t *acc, unsigned char item);
+/**
+ * @brief <Adds one item to an accumulator>
+ *
+ * <This function updates mean and variance with Welford's method.>
+ *
+ * @param <acc>           <pointer to accumulator>
+ * @param <item>          <data item>
+ *
+ * @return <void >
+ */
+
+
+
+void stats_push_block(stats_acc_t *acc, const unsigned char *dataSet, unsigned long data_length);
+/**
+ * @brief <Adds a block of items to an accumulator>
+ *
+ * <This function reads the block in chunks of STATS_BLOCK_LENGTH items, takes
+ *  exact integer sum and sum of squares per chunk and merges each chunk into the
+ *  accumulator (same result as stats_push per item, without a division per item).>
+ *
+ * @param <acc>           <pointer to accumulator>
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ *
+ * @return <void >
+ */
+
+
+
+void stats_merge(stats_acc_t *acc, const stats_acc_t *other);
+/**
+ * @brief <Adds the items of accumulator other to accumulator acc>
+ *
+ * <Afterwards acc holds the statistics of both inputs (Chan et al. parallel
+ *  variance), e.g. to combine per thread partial results. other is unchanged.>
+ *
+ * @param <acc>           <pointer to accumulator to merge into>
+ * @param <other>         <pointer to accumulator to merge from>
+ *
+ * @return <void >
+ */
+
+
+
+void stats_snapshot(const stats_acc_t *acc, stats_result_t *result);
+/**
+ * @brief <Reads the statistics of an accumulator>
+ *
+ * <This function fills *result as compute_statistics would for all items pushed
+ *  so far; stats_value_at_rank and stats_percentile work on it. The accumulator is
+ *  unchanged and can take more items.>
+ *
+ * @param <acc>           <pointer to accumulator>
+ * @param <result>        <pointer to statistics to fill>
+ *
+ * @return <void : results in *result >
+ */
+
+
+
+unsigned char stats_value_at_rank(const stats_result_t *result, unsigned long rank);
+/**
+ * @brief <Returns the item at a position of the sorted (smallest first) data set>
+ *
+ * <This function walks the histogram of compute_statistics - no sorting needed.
+ *  Ranks past the end return the maximum.>
+ *
+ * @param <result>        <statistics from compute_statistics>
+ * @param <rank>          <0 based position, 0 is the smallest item>
+ *
+ * @return <item at rank of type (unsigned char) >
+ */
+
+
+
+unsigned char stats_percentile(const stats_result_t *result, unsigned int percent);
+/**
+ * @brief <Returns a percentile (nearest rank) of the data set>
+ *
+ * <This function returns the smallest item which has at least percent % of the items
+ *  at or below it. 0 gives the minimum, 50 the lower median, 100 the maximum.>
+ *
+ * @param <result>        <statistics from compute_statistics>
+ * @param <percent>       <0 - 100>
+ *
+ * @return <percentile of type (unsigned char) >
+ */
+
+
+
+const stats_print_options_t *stats_print_install(const stats_print_options_t *options);
+/**
+ * @brief <Sets the options used by print_array (and print_statistics)>
+ *
+ * <The options are not copied - they must stay valid while installed.
+ *  NULL installs the default: every item, STATS_PRINT_COLUMNS per row.>
+ *
+ * @param <options>       <pointer to options or NULL>
+ *
+ * @return <previously installed options (NULL for the default) >
+ */
+
+
+
+stats_writer_t stats_writer_install(stats_writer_t writer);
+/**
+ * @brief <Sets where print_array and print_statistics write their text>
+ *
+ * <The writer gets the buffered text in pieces of at most
+ *  STATS_PRINT_BUFFER_SIZE bytes. NULL installs the default, fwrite to stdout.>
+ *
+ * @param <writer>        <text writer or NULL>
+ *
+ * @return <previous writer (never NULL) >
+ */
+
+
+
 void print_array(unsigned char *dataSet, unsigned long data_length);
 /**
  * @brief <Given an array of data and a length, prints the array to the screen>
  *
- * <This function prints the a given data set to screen >
+ * <This function prints the a given data set to screen (VERBOSE builds), as
+ *  set by stats_print_install: all items, a summary or a sample, in rows of a
+ *  given no of columns. Rows are rendered with my_itoa into a buffer on the
+ *  stack and handed to the writer (stats_writer_install) once per
+ *  STATS_PRINT_BUFFER_SIZE bytes.>
  *
  * @param <dataSet>       <pointer (memory address) to data set>
  * @param <data_length>   <no of item in data set (array)
@@ -63,9 +329,10 @@ unsigned char find_median(unsigned char *dataSet, unsigned long data_length);
 /**
  * @brief <Given an array of data and a length, returns the median value>
  *
- * <This function sorts the dataset from largest to smallest using the sort_array function.
- *  and then returns the data value in the middle position of the data set depending on
- *  the number of data items (even or odd) in the data array>
+ * <This function counts the data values into a 256 bin histogram (compute_statistics)
+ *  and walks it to the middle position of the data set, O(n). For an odd number of
+ *  data items the middle item is returned, for an even number the mean of the two
+ *  middle items (rounded down). The data set is not sorted or modified.>
  *
  * @param <dataSet>       <pointer (memory address) to data set>
  * @param <data_length>   <no of item in data set (array)
@@ -75,6 +342,48 @@ unsigned char find_median(unsigned char *dataSet, unsigned long data_length);
 
 
 
+unsigned char find_median_i32(int32_t *dataSet, unsigned long data_length, unsigned char in_place,
+                              int32_t *median);
+/**
+ * @brief <Given an array of 32-bit data and a length, finds the median value>
+ *
+ * <This function finds the middle item(s) with introselect (stats_select_i32:
+ *  quickselect with a median of three pivot and a heap sort fallback), O(n) on average and
+ *  O(n log n) worst case. For an even number of data items the mean of the two
+ *  middle items (rounded toward zero) is returned.
+ *  With in_place = 0 the data set is copied to words from reserve_words and left
+ *  unchanged; with in_place = 1 the data set itself is reordered (no copy).>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <in_place>      <1: data set may be reordered, 0: data set is not modified>
+ * @param <median>        <pointer to the median of the data set, 0 if empty or on failure>
+ *
+ * @return <1 on success, 0 if no words for the copy (in_place = 0) >
+ */
+
+
+
+void find_min_max_sum(const unsigned char *dataSet, unsigned long data_length,
+                      stats_minmaxsum_t *result);
+/**
+ * @brief <Given an array of data and a length, returns minimum, maximum and sum>
+ *
+ * <This function scans the data set once with a vector kernel:
+ *       HOST   : SSE2 / AVX2 (pminub, pmaxub, psadbw), picked at run time from cpuid
+ *       MSP432 : Cortex-M4 SIMD (__USUB8 / __SEL, __USADA8)
+ *  and falls back to a scalar loop elsewhere. The data set is not modified.
+ *  An empty data set gives 0 for all results.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <result>        <pointer to results>
+ *
+ * @return <void : results in *result >
+ */
+
+
+
 unsigned long find_mean(unsigned char *dataSet, unsigned long data_length);
 /**
  * @brief <Given an array of data and a length, returns the mean>
@@ -94,8 +403,8 @@ unsigned char find_maximum(unsigned char *dataSet, unsigned long data_length);
 /**
  * @brief <Given an array of data and a length, returns the maximum>
  *
- * <This function sorts the dataset from largest to smallest using the sort_array function
- *  and then returns the largest data item as minimum>
+ * <This function scans the dataset with find_min_max_sum (the data set is not sorted)
+ *  and then returns the largest data item as maximum>
  *
  * @param <dataSet>       <pointer (memory address) to data set>
  * @param <data_length>   <no of item in data set (array)
@@ -110,7 +419,7 @@ unsigned char find_minimum(unsigned char *, unsigned long data_length);
 /**
  * @brief <Given an array of data and a length, returns the minimum>
  *
- * <This function sorts the dataset from largest to smallest using the sort_array function
+ * <This function scans the dataset with find_min_max_sum (the data set is not sorted)
  *  and then returns the smallest data item as minimum>
  *
  * @param <dataSet>       <pointer (memory address) to data set>
@@ -130,6 +439,8 @@ void sort_array(unsigned char *, unsigned long data_length);
  * < Given an array of data and a length, sorts the array from largest to smallest. 
  *   (The zeroth Element should be the largest value, and the last element (n-1) should 
  *   be the smallest value
+ *   Data sets of up to STATS_SMALL_SORT_LENGTH items are insertion sorted, larger ones
+ *   are counting sorted over the 256 possible values in O(n + 256).
  * >
  *
  * @param <dataSet>     <pointer (memory address) to data set>
@@ -0,0 +1,177 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file <stats_generic.h>
+ * @brief <Statistics for 8/16/32-bit integer and floating point data>
+ *
+ * <This file contains the declarations of the statistics functions for data
+ *  types other than unsigned char. There is one function per data type
+ *  (suffix u8, i16, u16, i32, f32, f64); compilers for C11 or later also get
+ *  the type generic macros stats_compute and stats_select.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#ifndef __STATS_GENERIC_H__
+#define __STATS_GENERIC_H__
+
+#include <stdint.h>
+#include "stats.h"
+
+#ifndef STATS_RADIX_BITS
+#if defined (HOST)
+#define STATS_RADIX_BITS  (11)     // digit of 32/64-bit keys - 2048 counters fit L1
+#else
+#define STATS_RADIX_BITS  (8)      // small RAM - 256 counters per digit
+#endif
+#endif
+
+/**
+ * @brief <Statistics of a data set of any type, filled by stats_compute_*>
+ *
+ * <count     : no of items in data set
+ *  sum       : sum of all items
+ *  minimum   : smallest item
+ *  maximum   : largest item
+ *  mean      : sum / count
+ *  median    : middle item, or mean of the two middle items for an even count
+ *  variance  : population variance (sum of squared deviations / count)
+ *
+ *  All values are doubles, which hold every 32-bit integer exactly.>
+ */
+typedef struct {
+    unsigned long count;
+    double        sum;
+    double        minimum;
+    double        maximum;
+    double        mean;
+    double        median;
+    double        variance;
+} stats_generic_result_t;
+
+
+
+unsigned char stats_compute_u8 (const uint8_t  *dataSet, unsigned long data_length, stats_generic_result_t *result);
+unsigned char stats_compute_i16(const int16_t  *dataSet, unsigned long data_length, stats_generic_result_t *result);
+unsigned char stats_compute_u16(const uint16_t *dataSet, unsigned long data_length, stats_generic_result_t *result);
+unsigned char stats_compute_i32(const int32_t  *dataSet, unsigned long data_length, stats_generic_result_t *result);
+unsigned char stats_compute_f32(const float    *dataSet, unsigned long data_length, stats_generic_result_t *result);
+unsigned char stats_compute_f64(const double   *dataSet, unsigned long data_length, stats_generic_result_t *result);
+/**
+ * @brief <Computes all statistics of a data set, one function per data type>
+ *
+ * <The data set is not modified. The median is found with the fastest method
+ *  for the width of the type:
+ *   u8       : 256 bin histogram (compute_statistics), one pass
+ *   i16, u16 : 256 bin histogram of the high byte, then of the low byte inside the
+ *              bucket(s) holding the middle, two passes and no copy
+ *   i32, f32, f64 : stats_select_* on a copy from reserve_words
+ *  Mean and variance take a second pass around the mean (no cancellation).
+ *  Floating point data must not contain NaN.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <result>        <pointer to statistics to fill>
+ *
+ * @return <1 on success, 0 if no words for the median copy (median is then 0) >
+ */
+
+
+
+void stats_select_u8 (uint8_t  *dataSet, unsigned long data_length, unsigned long rank);
+void stats_select_i16(int16_t  *dataSet, unsigned long data_length, unsigned long rank);
+void stats_select_u16(uint16_t *dataSet, unsigned long data_length, unsigned long rank);
+void stats_select_i32(int32_t  *dataSet, unsigned long data_length, unsigned long rank);
+void stats_select_f32(float    *dataSet, unsigned long data_length, unsigned long rank);
+void stats_select_f64(double   *dataSet, unsigned long data_length, unsigned long rank);
+/**
+ * @brief <Moves the item of a given rank into its sorted position (nth element)>
+ *
+ * <This function reorders the data set so that dataSet[rank] holds the item which
+ *  would be there if the data set were sorted smallest first, with all items
+ *  before it <= and all after it >=. Introselect: quickselect with a median of
+ *  three pivot, O(n) on average, heap sort after 2 log2 n bad rounds so the
+ *  worst case is O(n log n). Items are compared with < and >, so -0.0 and +0.0
+ *  are equal and either may end up at rank; data must not contain NaN.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <rank>          <0 based position, 0 is the smallest item, < data_length>
+ *
+ * @return <void : data set reordered >
+ */
+
+
+
+void stats_sort_u16(uint16_t *dataSet, uint16_t *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_i16(int16_t  *dataSet, int16_t  *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_u32(uint32_t *dataSet, uint32_t *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_i32(int32_t  *dataSet, int32_t  *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_u64(uint64_t *dataSet, uint64_t *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_i64(int64_t  *dataSet, int64_t  *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_f32(float    *dataSet, float    *scratch, unsigned long data_length, unsigned char descending);
+void stats_sort_f64(double   *dataSet, double   *scratch, unsigned long data_length, unsigned char descending);
+/**
+ * @brief <Sorts a data set with an LSD radix sort>
+ *
+ * <Each item is turned into an unsigned key with the same order (sign bit flipped
+ *  for signed integers, IEEE 754 sign-magnitude mapped to two's order for
+ *  floats; all bits inverted for descending order). One pass over the data set
+ *  counts the digits of every key, then each digit is a stable scatter pass
+ *  between dataSet and scratch. Passes where all items share the digit are
+ *  skipped. 16-bit keys use 8-bit digits (2 passes), 32/64-bit keys
+ *  STATS_RADIX_BITS-bit digits (HOST: 11 bits, 3 / 6 passes). The sort is
+ *  stable and the result is always in dataSet.
+ *  -0.0 sorts below +0.0, data must not contain NaN, data_length < 2^32.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <scratch>       <pointer to data_length items of scratch memory>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <descending>    <0: smallest first, 1: largest first (as sort_array)>
+ *
+ * @return <void : data set sorted >
+ */
+
+
+
+#if defined (__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+/* C11 - pick the function from the type of the data set */
+#define STATS_GENERIC_PICK(dataSet, name)                                   \
+    _Generic((dataSet),                                                     \
+        uint8_t *:  name##_u8,  const uint8_t *:  name##_u8,               \
+        int16_t *:  name##_i16, const int16_t *:  name##_i16,              \
+        uint16_t *: name##_u16, const uint16_t *: name##_u16,              \
+        int32_t *:  name##_i32, const int32_t *:  name##_i32,              \
+        float *:    name##_f32, const float *:    name##_f32,              \
+        double *:   name##_f64, const double *:   name##_f64)
+
+/* stats_select reorders the data set - no const entries, so a const data set
+ * does not compile instead of losing its const */
+#define STATS_GENERIC_PICK_MUTABLE(dataSet, name)                           \
+    _Generic((dataSet),                                                     \
+        uint8_t *:  name##_u8,                                              \
+        int16_t *:  name##_i16,                                             \
+        uint16_t *: name##_u16,                                             \
+        int32_t *:  name##_i32,                                             \
+        float *:    name##_f32,                                             \
+        double *:   name##_f64)
+
+#define stats_compute(dataSet, data_length, result) \
+    STATS_GENERIC_PICK(dataSet, stats_compute)(dataSet, data_length, result)
+#define stats_select(dataSet, data_length, rank) \
+    STATS_GENERIC_PICK_MUTABLE(dataSet, stats_select)(dataSet, data_length, rank)
+#endif
+
+
+
+#endif /* __STATS_GENERIC_H__ */
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file <stats_parallel.h>
+ * @brief <Multithreaded statistics declaration>
+ *
+ * <This file contains the declarations of the statistics and sort drivers which
+ *  split large data sets across threads (HOST, POSIX threads). On other
+ *  platforms the same functions run single threaded.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#ifndef __STATS_PARALLEL_H__
+#define __STATS_PARALLEL_H__
+
+#include <stdint.h>
+#include "stats.h"
+#include "task_pool.h"
+
+#ifndef STATS_PARALLEL_CHUNK_LENGTH
+#define STATS_PARALLEL_CHUNK_LENGTH  (256UL*1024UL)       // items per chunk - fits L2 cache
+#endif
+#ifndef STATS_PARALLEL_MIN_LENGTH
+#define STATS_PARALLEL_MIN_LENGTH    (4UL*1024UL*1024UL)  // single threaded below
+#endif
+#define STATS_PARALLEL_MAX_THREADS   (64)
+#define STATS_SORT_LEAF_LENGTH       (64UL*1024UL)        // min leaf items - a task per leaf pays off
+#define STATS_SORT_LEAVES_PER_THREAD (4)                  // leaves (and spare to steal) per thread
+#define STATS_SORT_MERGE_GRAIN       (64UL*1024UL)        // min items per merge path part
+#define STATS_SORT_MAX_PARTS         (64)                 // merge path parts per merge
+
+
+
+void compute_statistics_parallel(const unsigned char *dataSet, unsigned long data_length,
+                                 stats_result_t *result, task_pool_t *pool);
+/**
+ * @brief <Computes all statistics of a data set with all threads of a task pool>
+ *
+ * <This function splits the data set into chunks of STATS_PARALLEL_CHUNK_LENGTH
+ *  items (smaller if there are fewer chunks than threads). One task per pool
+ *  thread takes the next free chunk and adds it to its own stats_acc_t (sum,
+ *  min, max, histogram, variance); the pool threads are reused, no thread is
+ *  started per call. The partial results are then combined with a tree merge -
+ *  in round r partial i takes in partial i + 2^r - and *result is filled as
+ *  compute_statistics would (variance may differ in the last digits).
+ *
+ *  Data sets shorter than STATS_PARALLEL_MIN_LENGTH, where waking the pool
+ *  costs more than it saves, a NULL pool, a pool of 1 thread or a platform
+ *  without threads call compute_statistics instead.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <result>        <pointer to statistics to fill>
+ * @param <pool>          <task pool from task_pool_create, or NULL>
+ *
+ * @return <void : results in *result >
+ */
+
+
+
+void print_statistics_parallel(unsigned char *dataSet, unsigned long data_length,
+                               task_pool_t *pool);
+/**
+ * @brief <print_statistics with the statistics from compute_statistics_parallel>
+ *
+ * <The output is the same as print_statistics.>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <pool>          <task pool from task_pool_create, or NULL>
+ *
+ * @return <void : prints to screen >
+ */
+
+
+
+void sort_parallel_i32(int32_t *dataSet, int32_t *scratch, unsigned long data_length,
+                       unsigned char descending, task_pool_t *pool);
+/**
+ * @brief <Sorts 32-bit data with all threads of a task pool (merge sort)>
+ *
+ * <This function splits the data set in halves as tasks until there are about
+ *  STATS_SORT_LEAVES_PER_THREAD leaves per thread, but no leaf is split below
+ *  STATS_SORT_LEAF_LENGTH items. Leaves are therefore data_length / (4 * threads)
+ *  items and grow with the data set - they do not fit L2 for large ones. That
+ *  is on purpose: leaves are sorted by stats_sort_i32 (O(n) streaming passes,
+ *  one per digit), while every merge level is another pass over all items, so
+ *  a merge level saved is worth more than a leaf in cache. Sorted halves are merged back in ping-pong between dataSet
+ *  and scratch; large merges are cut into parts of equal output size with merge
+ *  path (binary search along the cross diagonals), each part a task. Idle
+ *  threads steal the largest waiting tasks, so the load balances itself.
+ *  With a NULL pool this is stats_sort_i32 (single threaded radix sort).>
+ *
+ * @param <dataSet>       <pointer (memory address) to data set>
+ * @param <scratch>       <pointer to data_length items of scratch memory>
+ * @param <data_length>   <no of item in data set (array)
+ * @param <descending>    <0: smallest first, 1: largest first (as sort_array)>
+ * @param <pool>          <task pool from task_pool_create, or NULL>
+ *
+ * @return <void : data set sorted >
+ */
+
+
+
+#endif /* __STATS_PARALLEL_H__ */
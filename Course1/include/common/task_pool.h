@@ -0,0 +1,151 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file <task_pool.h>
+ * @brief <Work stealing task pool declaration>
+ *
+ * <This file contains the declarations of a fork-join task pool. Each thread
+ *  owns a double ended queue of tasks: it pushes and pops its own tasks at one
+ *  end (newest first, cache warm) while idle threads steal the oldest tasks
+ *  (the largest pieces of work) from the other end.
+ *
+ *  Usage:
+ *      task_group_t group;
+ *      task_t task;
+ *      task_group_init(&group);
+ *      task_spawn(pool, &group, &task, fn, arg);    // may run on another thread
+ *      ... other work ...
+ *      task_wait(pool, &group);                     // runs tasks while waiting
+ *
+ *  Tasks may spawn and wait themselves. The task_t and task_group_t memory is
+ *  provided by the caller (no allocation) and must stay valid until task_wait
+ *  returns. A NULL pool, or a platform without threads, runs every task at
+ *  task_spawn.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#ifndef __TASK_POOL_H__
+#define __TASK_POOL_H__
+
+#define TASK_POOL_MAX_THREADS  (64)
+#define TASK_DEQUE_SIZE        (1024)  // tasks per thread - a full deque runs the task at spawn
+
+typedef void (*task_fn_t)(void *arg);
+
+/**
+ * @brief <Tasks spawned and not yet finished, see task_group_init>
+ */
+typedef struct {
+    unsigned long pending;
+} task_group_t;
+
+/**
+ * @brief <One spawned task - storage given to task_spawn>
+ */
+typedef struct {
+    task_fn_t    fn;
+    void         *arg;
+    task_group_t *group;
+} task_t;
+
+/**
+ * @brief <Thread pool, see task_pool_create - contents are private>
+ */
+typedef struct task_pool task_pool_t;
+
+
+
+task_pool_t *task_pool_create(unsigned int threads);
+/**
+ * @brief <Starts a task pool>
+ *
+ * <This function starts threads - 1 worker threads; the thread which calls
+ *  task_wait works as the last one. Only one thread outside the pool may use
+ *  it at a time. threads = 0 takes the no of online CPUs.>
+ *
+ * @param <threads>       <no of threads incl. the calling thread, 0 for all CPUs>
+ *
+ * @return <pointer to the pool, NULL if no threads on this platform or out of memory >
+ */
+
+
+
+void task_pool_destroy(task_pool_t *pool);
+/**
+ * @brief <Stops the worker threads and frees the pool (NULL is ignored)>
+ *
+ * @param <pool>          <pointer to pool from task_pool_create>
+ *
+ * @return <void >
+ */
+
+
+
+unsigned int task_pool_threads(const task_pool_t *pool);
+/**
+ * @brief <Returns the no of threads of a pool incl. the calling thread (1 for NULL)>
+ *
+ * @param <pool>          <pointer to pool from task_pool_create or NULL>
+ *
+ * @return <no of threads >
+ */
+
+
+
+void task_group_init(task_group_t *group);
+/**
+ * @brief <Empties a task group before its first task_spawn>
+ *
+ * @param <group>         <pointer to group>
+ *
+ * @return <void >
+ */
+
+
+
+void task_spawn(task_pool_t *pool, task_group_t *group, task_t *task,
+                task_fn_t fn, void *arg);
+/**
+ * @brief <Queues fn(arg) as a task of group>
+ *
+ * <The task goes to the calling thread's queue where any thread of the pool may
+ *  pick it up. With a NULL pool or a full queue fn runs before task_spawn returns.>
+ *
+ * @param <pool>          <pointer to pool or NULL>
+ * @param <group>         <group the task belongs to>
+ * @param <task>          <storage for the task, valid until task_wait returns>
+ * @param <fn>            <function to run>
+ * @param <arg>           <argument of fn>
+ *
+ * @return <void >
+ */
+
+
+
+void task_wait(task_pool_t *pool, task_group_t *group);
+/**
+ * @brief <Returns once all tasks of group have finished>
+ *
+ * <While tasks of the group are pending the calling thread runs tasks of its
+ *  own queue and steals from the other threads.>
+ *
+ * @param <pool>          <pointer to pool or NULL>
+ * @param <group>         <group to wait for>
+ *
+ * @return <void >
+ */
+
+
+
+#endif /* __TASK_POOL_H__ */
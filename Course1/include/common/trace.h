@@ -0,0 +1,182 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file <trace.h>
+ * @brief <Deferred binary trace log>
+ *
+ * <This file contains the declarations of the trace log. A TRACE call does not
+ *  format anything: it stores the id of its format string (the address of a
+ *  static trace_format_t made at the call site) and its raw arguments in one
+ *  record of a lock free ring buffer - a compare and swap, a few stores and no
+ *  locks, so TRACE may be used from several threads and from interrupts.
+ *  Formatting is done later by trace_flush, which decodes the records in order
+ *  and hands the text to the sink (stdout on HOST; none on MSP432 until one is
+ *  installed, e.g. a UART writer, so the records wait in RAM for the debugger).
+ *  On HOST trace_decoder_start runs trace_flush on a background thread.
+ *
+ *  Arguments are stored as trace_arg_t (pointer sized integers), so they must be
+ *  integers, characters or pointers; %s arguments must point to strings which
+ *  live until the record is decoded (literals, static tables). Floating point
+ *  and '*' widths are not supported. If the ring is full the record is dropped
+ *  and counted; the next trace_flush reports the count.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef TRACE_RING_SIZE
+#if defined (HOST)
+#define TRACE_RING_SIZE   (4096)              // records - power of 2
+#else
+#define TRACE_RING_SIZE   (64)                // records - power of 2, 2 KB RAM
+#endif
+#endif
+#define TRACE_MAX_ARGS    (6)                 // arguments per record
+#define TRACE_TEXT_SIZE   (256)               // longest decoded line, longer ones are cut
+
+typedef uintptr_t trace_arg_t;
+
+/**
+ * @brief <Call site of TRACE - its address is the id of the format string>
+ */
+typedef struct {
+    const char *format;                       // printf format string
+} trace_format_t;
+
+/**
+ * @brief <Receives the decoded text of trace_flush (length bytes, no 0 at the end)>
+ */
+typedef void (*trace_sink_t)(const char *text, size_t length);
+
+/**
+ * @brief <Stores a format string and up to TRACE_MAX_ARGS arguments for trace_flush>
+ *
+ * <Used as printf: TRACE("value %d of %s\n", value, name). The format string
+ *  must be a string literal.>
+ */
+#define TRACE(...)          TRACE_CAT(TRACE_, TRACE_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+#define TRACE_NARGS(...)    TRACE_NARGS_(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, _)
+#define TRACE_NARGS_(f, a1, a2, a3, a4, a5, a6, n, ...)  n
+#define TRACE_CAT(a, b)     TRACE_CAT_(a, b)
+#define TRACE_CAT_(a, b)    a##b
+#define TRACE_A(x)          ((trace_arg_t)(x))
+#define TRACE_WRITE(f, a, b, c, d, e, g)                                      \
+    do {                                                                      \
+        static const trace_format_t trace_format_ = { f };                    \
+        trace_write(&trace_format_, a, b, c, d, e, g);                        \
+    } while (0)
+
+#define TRACE_0(f)                    TRACE_WRITE(f, 0, 0, 0, 0, 0, 0)
+#define TRACE_1(f, a)                 TRACE_WRITE(f, TRACE_A(a), 0, 0, 0, 0, 0)
+#define TRACE_2(f, a, b)              TRACE_WRITE(f, TRACE_A(a), TRACE_A(b), 0, 0, 0, 0)
+#define TRACE_3(f, a, b, c)           TRACE_WRITE(f, TRACE_A(a), TRACE_A(b), TRACE_A(c), 0, 0, 0)
+#define TRACE_4(f, a, b, c, d)        TRACE_WRITE(f, TRACE_A(a), TRACE_A(b), TRACE_A(c),   \
+                                                  TRACE_A(d), 0, 0)
+#define TRACE_5(f, a, b, c, d, e)     TRACE_WRITE(f, TRACE_A(a), TRACE_A(b), TRACE_A(c),   \
+                                                  TRACE_A(d), TRACE_A(e), 0)
+#define TRACE_6(f, a, b, c, d, e, g)  TRACE_WRITE(f, TRACE_A(a), TRACE_A(b), TRACE_A(c),   \
+                                                  TRACE_A(d), TRACE_A(e), TRACE_A(g))
+
+
+
+void trace_write(const trace_format_t *format,
+                 trace_arg_t a0, trace_arg_t a1, trace_arg_t a2,
+                 trace_arg_t a3, trace_arg_t a4, trace_arg_t a5);
+/**
+ * @brief <Stores one record in the ring buffer (called by TRACE)>
+ *
+ * <Lock free, any number of writers. Drops the record if the ring is full.>
+ *
+ * @param <format>        <call site of TRACE>
+ * @param <a0 .. a5>      <arguments, 0 for the unused ones>
+ *
+ * @return <void >
+ */
+
+
+
+unsigned long trace_flush(void);
+/**
+ * @brief <Decodes all complete records in order and writes them to the sink>
+ *
+ * <One reader at a time - concurrent calls wait for each other. A record whose
+ *  writer has not finished yet stops the flush; it is decoded next time. Without
+ *  a sink the records stay in the ring.>
+ *
+ * @return <no of records decoded >
+ */
+
+
+
+size_t trace_format(const trace_format_t *format, const trace_arg_t *args,
+                    char *text, size_t size);
+/**
+ * @brief <Formats one record as snprintf would (the decoder of trace_flush)>
+ *
+ * @param <format>        <call site of TRACE>
+ * @param <args>          <TRACE_MAX_ARGS arguments of the record>
+ * @param <text>          <buffer for the text, 0 terminated>
+ * @param <size>          <size of text in bytes, more than 0>
+ *
+ * @return <length of the text (cut at size - 1) >
+ */
+
+
+
+trace_sink_t trace_sink_install(trace_sink_t sink);
+/**
+ * @brief <Sets where trace_flush writes the decoded text>
+ *
+ * @param <sink>          <text writer, NULL to keep records in the ring>
+ *
+ * @return <previous sink >
+ */
+
+
+
+unsigned long trace_dropped(void);
+/**
+ * @brief <Returns the no of records dropped because the ring was full>
+ *
+ * @return <records dropped since start >
+ */
+
+
+
+int trace_decoder_start(unsigned int period_ms);
+/**
+ * @brief <Starts a background thread which calls trace_flush every period (HOST)>
+ *
+ * @param <period_ms>     <time between flushes in milliseconds>
+ *
+ * @return <1 if the thread runs, 0 if not supported or already running >
+ */
+
+
+
+void trace_decoder_stop(void);
+/**
+ * @brief <Stops the background thread and flushes what is left>
+ *
+ * @return <void >
+ */
+
+
+
+#endif /* __TRACE_H__ */
@@ -23,6 +23,11 @@ ifeq ($(PLATFORM),MSP432)
 	    $(SRC_FILE_PATH)/memory.c                     \
 	    $(SRC_FILE_PATH)/course1.c                    \
 	    $(SRC_FILE_PATH)/stats.c                      \
+	    $(SRC_FILE_PATH)/stats_parallel.c             \
+	    $(SRC_FILE_PATH)/stats_generic.c              \
+	    $(SRC_FILE_PATH)/task_pool.c                  \
+	    $(SRC_FILE_PATH)/cpu_dispatch.c               \
+	    $(SRC_FILE_PATH)/trace.c                      \
 	    $(SRC_FILE_PATH)/startup_msp432p401r_gcc.c    \
 	    $(SRC_FILE_PATH)/system_msp432p401r.c         \
 	    $(SRC_FILE_PATH)/interrupts_msp432p401r_gcc.c
@@ -42,7 +47,25 @@ else
 	    $(SRC_FILE_PATH)/data.c                       \
 	    $(SRC_FILE_PATH)/memory.c                     \
 	    $(SRC_FILE_PATH)/course1.c                    \
-	    $(SRC_FILE_PATH)/stats.c                      
+	    $(SRC_FILE_PATH)/stats.c                      \
+	    $(SRC_FILE_PATH)/stats_parallel.c             \
+	    $(SRC_FILE_PATH)/stats_generic.c              \
+	    $(SRC_FILE_PATH)/task_pool.c                  \
+	    $(SRC_FILE_PATH)/cpu_dispatch.c               \
+	    $(SRC_FILE_PATH)/trace.c
+
+        # Benchmark driver - replaces main.c & course1.c
+	BENCH_SOURCES =                                   \
+	    $(SRC_FILE_PATH)/bench.c                      \
+	    $(SRC_FILE_PATH)/bench_suite.c                \
+	    $(SRC_FILE_PATH)/data.c                       \
+	    $(SRC_FILE_PATH)/memory.c                     \
+	    $(SRC_FILE_PATH)/stats.c                      \
+	    $(SRC_FILE_PATH)/stats_parallel.c             \
+	    $(SRC_FILE_PATH)/stats_generic.c              \
+	    $(SRC_FILE_PATH)/task_pool.c                  \
+	    $(SRC_FILE_PATH)/cpu_dispatch.c               \
+	    $(SRC_FILE_PATH)/trace.c
 
         # Add your include paths to this variable
 	INCLUDES =                                  \
@@ -0,0 +1,608 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <bench.c>
+ * @brief  <Host benchmark driver for the memory, data and statistics functions>
+ *
+ * <This file contains a stand alone main used by the "bench" target of the
+ *  HOST build.
+ *
+ *  Use: bench.out [text | csv | json | tables] [filter]
+ *
+ *      text, csv, json : microbenchmark suite of every public function in
+ *                        memory.h, data.h and stats.h (bench_suite.c), only
+ *                        the functions whose name contains filter
+ *      tables          : comparison tables of the optimised functions against
+ *                        the original loops and libc. Each case is repeated
+ *                        until a minimum amount of data has been processed
+ *                        and the throughput is printed in GB/s.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "platform.h"
+#include "memory.h"
+#include "data.h"
+#include "stats.h"
+#include "stats_parallel.h"
+#include "stats_generic.h"
+#include "bench_suite.h"
+
+#define BENCH_MIN_SIZE     (16UL)                   // smallest buffer size in bytes
+#define BENCH_MAX_SIZE     (64UL*1024UL*1024UL)     // largest buffer size in bytes
+#define BENCH_MIN_BYTES    (256UL*1024UL*1024UL)    // bytes to process per case
+#define BENCH_MIN_REPS     (8UL)                    // repetitions per case
+#define BENCH_ALLOC_REPS   (10000000UL)             // reserve/free pairs per allocator
+#define BENCH_ALLOC_WORDS  (8UL)                    // words per reserve_words call
+#define BENCH_POOL_BLOCKS  (1024UL)                 // blocks of the pool latency case
+#define BENCH_ITOA_COUNT   (1UL << 20)              // random inputs per conversion case
+#define BENCH_ITOA_ROUNDS  (8UL)                    // passes over the inputs
+
+#define BENCH_ATOI_STRIDE  (12UL)                   // bytes per decimal string
+
+#define BENCH_SORT_MIN     (1UL << 10)              // smallest sort case in items
+#define BENCH_SORT_MAX     (1UL << 22)              // largest sort case in items
+
+#ifndef BENCH_STATS_BYTES
+#define BENCH_STATS_BYTES  (1UL << 30)              // data set for the thread scaling case
+#endif
+#define BENCH_STATS_SAMPLES (15U)                   // most timed calls of the thread scaling case
+#ifndef BENCH_PSORT_ITEMS
+#define BENCH_PSORT_ITEMS  (100000000UL)            // int32 items for the parallel sort case
+#endif
+
+typedef void (*bench_itoa_fn)(int32_t data, uint8_t * ptr);
+
+typedef void (*bench_copy_fn)(uint8_t * src, uint8_t * dst, size_t length);
+
+volatile uint8_t bench_sink;                        // keeps results alive
+
+
+
+/*------------------- bench_now ------------------------------------------------*
+ *
+ * Returns a monotonic time stamp in nanoseconds
+ *-----------------------------------------------------------------------------*/
+static double bench_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+
+
+/*------------------- copy_byte_loop -------------------------------------------*
+ *
+ * Reference: the original one byte per iteration my_memcopy loop
+ *-----------------------------------------------------------------------------*/
+static void copy_byte_loop(uint8_t * src, uint8_t * dst, size_t length){
+    volatile uint8_t * dst_ptr = dst;               // volatile - stop the compiler
+    size_t i;                                       // turning this into a memcpy call
+
+    for (i=0; i<length; i++){
+        dst_ptr[i] = src[i];
+    }
+}
+
+/*------------------- reverse_byte_loop ----------------------------------------*
+ *
+ * Reference: the original one byte pair per iteration my_reverse loop
+ *-----------------------------------------------------------------------------*/
+static void reverse_byte_loop(uint8_t * src, uint8_t * dst, size_t length){
+    volatile uint8_t * last_ptr_addr = src + (length-1);
+    volatile uint8_t * start_ptr_addr = src;
+    uint8_t tempByte;
+
+    (void)dst;
+    while (start_ptr_addr < last_ptr_addr){
+        tempByte = *start_ptr_addr;
+        *(start_ptr_addr++) = *last_ptr_addr;
+        *(last_ptr_addr--) = tempByte;
+    }
+}
+
+static void reverse_my_reverse(uint8_t * src, uint8_t * dst, size_t length){
+    (void)dst;
+    my_reverse(src, length);
+}
+
+static void copy_my_memcopy(uint8_t * src, uint8_t * dst, size_t length){
+    my_memcopy(src, dst, length);
+}
+
+static void copy_libc_memcpy(uint8_t * src, uint8_t * dst, size_t length){
+    memcpy(dst, src, length);
+}
+
+
+
+/*------------------- bench_copy -----------------------------------------------*
+ *
+ * Times one copy function for one size and returns throughput in GB/s
+ *-----------------------------------------------------------------------------*/
+static double bench_copy(bench_copy_fn fn, uint8_t * src, uint8_t * dst, size_t length){
+    unsigned long reps = BENCH_MIN_BYTES / length;
+    unsigned long i;
+    double start, elapsed;
+
+    if (reps < BENCH_MIN_REPS) reps = BENCH_MIN_REPS;
+
+    fn(src, dst, length);                           // warm up caches and page tables
+    start = bench_now();
+    for (i=0; i<reps; i++){
+        fn(src, dst, length);
+    }
+    elapsed = bench_now() - start;
+    bench_sink ^= dst[length-1] ^ src[0];
+
+    return ((double)length * (double)reps) / elapsed;  // bytes per ns == GB/s
+}
+
+
+
+/*------------------- itoa_digit_loop ------------------------------------------*
+ *
+ * Reference: the previous base 10 path - one % and one / by the run time
+ * base per digit, string built backwards in scratch and copied out
+ *-----------------------------------------------------------------------------*/
+static volatile uint32_t bench_base = 10;           // run time base, as in my_itoa
+
+static void itoa_digit_loop(int32_t data, uint8_t * ptr){
+    uint8_t buff[12];
+    uint8_t * end = buff + sizeof(buff);
+    uint8_t * digit = end;
+    uint32_t value = (data < 0) ? (0U - (uint32_t)data) : (uint32_t)data;
+    uint32_t base = bench_base;
+
+    do{
+        *(--digit) = (uint8_t)("0123456789ABCDEF"[value % base]);
+        value /= base;
+    }while (value != 0);
+    if (data < 0) *(--digit) = '-';
+    while (digit < end) *(ptr++) = *(digit++);
+    *ptr = '\0';
+}
+
+static void itoa_my_itoa(int32_t data, uint8_t * ptr){
+    my_itoa(data, ptr, 10);
+}
+
+static void itoa_snprintf(int32_t data, uint8_t * ptr){
+    snprintf((char *)ptr, 12, "%d", (int)data);
+}
+
+
+
+/*------------------- bench_itoa -----------------------------------------------*
+ *
+ * Converts the random inputs BENCH_ITOA_ROUNDS times and returns ns per call
+ *-----------------------------------------------------------------------------*/
+static double bench_itoa(bench_itoa_fn fn, const int32_t * inputs){
+    uint8_t text[40];
+    unsigned long i, round;
+    double start;
+
+    start = bench_now();
+    for (round=0; round<BENCH_ITOA_ROUNDS; round++){
+        for (i=0; i<BENCH_ITOA_COUNT; i++){
+            fn(inputs[i], text);
+            bench_sink ^= text[1];
+        }
+    }
+    return (bench_now() - start) / (double)(BENCH_ITOA_COUNT * BENCH_ITOA_ROUNDS);
+}
+
+
+
+/*------------------- bench_atoi -----------------------------------------------*
+ *
+ * Parses the decimal strings (BENCH_ATOI_STRIDE bytes apart) BENCH_ITOA_ROUNDS
+ * times with my_atoi_parse (use_strtol = 0) or strtol and returns ns per call
+ *-----------------------------------------------------------------------------*/
+static double bench_atoi(const uint8_t * text, uint8_t use_strtol){
+    unsigned long i, round;
+    int32_t value;
+    double start;
+
+    start = bench_now();
+    for (round=0; round<BENCH_ITOA_ROUNDS; round++){
+        for (i=0; i<BENCH_ITOA_COUNT; i++){
+            const uint8_t * str = text + (i * BENCH_ATOI_STRIDE);
+            if (use_strtol){
+                value = (int32_t)strtol((const char *)str, NULL, 10);
+            }else{
+                my_atoi_parse(str, 10, &value, NULL);
+            }
+            bench_sink ^= (uint8_t)value;
+        }
+    }
+    return (bench_now() - start) / (double)(BENCH_ITOA_COUNT * BENCH_ITOA_ROUNDS);
+}
+
+
+
+/*------------------- bench_alloc ----------------------------------------------*
+ *
+ * Times reserve_words / free_words pairs for the installed allocator and
+ * returns the cost of one pair in ns. An arena is reset after every pair.
+ *-----------------------------------------------------------------------------*/
+static double bench_alloc(size_t words, mem_arena_t * arena){
+    unsigned long i;
+    double start;
+    int32_t * block;
+
+    start = bench_now();
+    for (i=0; i<BENCH_ALLOC_REPS; i++){
+        block = reserve_words(words);
+        block[0] = (int32_t)i;
+        bench_sink ^= (uint8_t)block[0];
+        free_words((uint32_t *)block);
+        arena_reset(arena);                         // no-op for NULL
+    }
+    return (bench_now() - start) / (double)BENCH_ALLOC_REPS;
+}
+
+
+
+/*------------------- bench_psort ----------------------------------------------*
+ *
+ * Returns the seconds sort_parallel_i32 takes for a copy of input
+ * (pool = NULL: single threaded radix sort)
+ *-----------------------------------------------------------------------------*/
+static double bench_psort(const int32_t * input, int32_t * data, int32_t * scratch,
+                          size_t count, task_pool_t * pool){
+    double start;
+
+    memcpy(data, input, count * sizeof(int32_t));
+    start = bench_now();
+    sort_parallel_i32(data, scratch, count, 0, pool);
+    start = bench_now() - start;
+    bench_sink ^= (uint8_t)data[count / 2];
+    return start / 1e9;
+}
+
+
+
+/*------------------- BENCH_SORT_TYPE ------------------------------------------*
+ *
+ * Defines for key type T: sort_fill_<SFX> (random items from a xorshift64
+ * seed, GEN turns the 64 random bits r into an item), sort_radix_<SFX>
+ * (stats_sort_<SFX> ascending) and sort_compare_<SFX> (qsort comparator)
+ *-----------------------------------------------------------------------------*/
+#define BENCH_SORT_TYPE(T, SFX, GEN)                                           \
+static void sort_fill_##SFX(void * data, size_t count){                        \
+    T * items = (T *)data;                                                     \
+    uint64_t r = 88172645463325252ULL;                                         \
+    size_t i;                                                                  \
+    for (i=0; i<count; i++){                                                   \
+        r ^= r << 13; r ^= r >> 7; r ^= r << 17;                               \
+        items[i] = (GEN);                                                      \
+    }                                                                          \
+}                                                                              \
+static void sort_radix_##SFX(void * data, void * scratch, size_t count){      \
+    stats_sort_##SFX((T *)data, (T *)scratch, count, 0);                       \
+}                                                                              \
+static int sort_compare_##SFX(const void * a, const void * b){                \
+    T x = *(const T *)a;                                                       \
+    T y = *(const T *)b;                                                       \
+    return (x > y) - (x < y);                                                  \
+}
+
+BENCH_SORT_TYPE(uint16_t, u16, (uint16_t)r)
+BENCH_SORT_TYPE(int32_t,  i32, (int32_t)r)
+BENCH_SORT_TYPE(uint64_t, u64, r)
+BENCH_SORT_TYPE(float,    f32, (float)(int32_t)r / 1024.0f)
+BENCH_SORT_TYPE(double,   f64, (double)(int64_t)r / 1e6)
+
+/* One key type of the sort case */
+typedef struct {
+    const char * name;
+    size_t       size;                              // bytes per item
+    void (*fill)(void * data, size_t count);
+    void (*radix)(void * data, void * scratch, size_t count);
+    int  (*compare)(const void * a, const void * b);
+} bench_sort_type_t;
+
+static const bench_sort_type_t bench_sort_types[] = {
+    { "uint16", sizeof(uint16_t), sort_fill_u16, sort_radix_u16, sort_compare_u16 },
+    { "int32",  sizeof(int32_t),  sort_fill_i32, sort_radix_i32, sort_compare_i32 },
+    { "uint64", sizeof(uint64_t), sort_fill_u64, sort_radix_u64, sort_compare_u64 },
+    { "float",  sizeof(float),    sort_fill_f32, sort_radix_f32, sort_compare_f32 },
+    { "double", sizeof(double),   sort_fill_f64, sort_radix_f64, sort_compare_f64 },
+};
+
+
+
+/*------------------- bench_sort -----------------------------------------------*
+ *
+ * Returns the ns per item to sort count random items of a key type with
+ * stats_sort_* (use_qsort = 0) or qsort. input holds the random items, each
+ * repetition sorts a fresh copy in data; only the sort is timed.
+ *-----------------------------------------------------------------------------*/
+static double bench_sort(const bench_sort_type_t * type, const uint8_t * input,
+                         uint8_t * data, uint8_t * scratch, size_t count,
+                         uint8_t use_qsort){
+    unsigned long reps = BENCH_SORT_MAX / count;
+    double total = 0.0;
+    unsigned long r;
+
+    for (r=0; r<reps; r++){
+        double start;
+        memcpy(data, input, count * type->size);
+        start = bench_now();
+        if (use_qsort){
+            qsort(data, count, type->size, type->compare);
+        }else{
+            type->radix(data, scratch, count);
+        }
+        total += bench_now() - start;
+        bench_sink ^= data[0];
+    }
+    return total / ((double)reps * (double)count);
+}
+
+
+
+/*------------------- bench_stats ----------------------------------------------*
+ *
+ * Returns the GB/s of compute_statistics_parallel over the data set on a pool
+ * of threads (threads = 1 runs compute_statistics). The pool is started once,
+ * outside the timing; after a warm up call the calls are repeated until the
+ * median is stable (as bench_suite does) and the median time is reported.
+ *-----------------------------------------------------------------------------*/
+static double bench_stats(const uint8_t * data, size_t length, unsigned int threads){
+    stats_result_t result;
+    task_pool_t * pool = (threads > 1) ? task_pool_create(threads) : NULL;
+    double sorted[BENCH_STATS_SAMPLES];             // times so far, smallest first
+    double median, previous = 0.0;
+    unsigned int count, stable = 0, j;
+
+    compute_statistics_parallel(data, length, &result, pool);  // warm up, wake the pool
+    for (count=0; count<BENCH_STATS_SAMPLES; ){
+        double start = bench_now();
+        double elapsed;
+
+        compute_statistics_parallel(data, length, &result, pool);
+        elapsed = bench_now() - start;
+        bench_sink ^= result.median;
+
+        for (j=count++; (j > 0) && (sorted[j-1] > elapsed); j--){
+            sorted[j] = sorted[j-1];
+        }
+        sorted[j] = elapsed;
+
+        median = (count & 1U) ? sorted[count / 2] : ((sorted[(count / 2) - 1] + sorted[count / 2]) / 2.0);
+        if ((count > 1) && ((median - previous) <= (previous * (BENCH_STABLE_PERCENT / 100.0))) &&
+                           ((previous - median) <= (previous * (BENCH_STABLE_PERCENT / 100.0)))){
+            stable++;
+        }else{
+            stable = 0;
+        }
+        previous = median;
+        if (stable >= BENCH_STABLE_SAMPLES) break;
+    }
+    task_pool_destroy(pool);
+    return (double)length / previous;
+}
+
+
+
+/*------------------- bench_tables ---------------------------------------------*
+ *
+ * Prints the comparison tables, returns 1 if out of memory. Every buffer is
+ * freed at done, also when a later table runs out of memory.
+ *-----------------------------------------------------------------------------*/
+static int bench_tables(void){
+    uint8_t * src = (uint8_t *)malloc(BENCH_MAX_SIZE);
+    uint8_t * dst = (uint8_t *)malloc(BENCH_MAX_SIZE);
+    uint8_t * sort_scratch = NULL;
+    uint8_t * stats_data = NULL;
+    int32_t * psort_input = NULL;
+    int32_t * psort_data = NULL;
+    int32_t * psort_scratch = NULL;
+    size_t length;
+    int ret = 1;
+
+    if ((src == NULL) || (dst == NULL)) goto done;
+    memset(src, 0x5A, BENCH_MAX_SIZE);
+    memset(dst, 0x00, BENCH_MAX_SIZE);
+
+    PRINTF("\n*** my_memcopy THROUGHPUT (GB/s) ***\n\n");
+    PRINTF("%12s %12s %12s %12s\n", "bytes", "byte_loop", "my_memcopy", "memcpy");
+    for (length = BENCH_MIN_SIZE; length <= BENCH_MAX_SIZE; length *= 2){
+        PRINTF("%12lu %12.2f %12.2f %12.2f\n", (unsigned long)length,
+               bench_copy(copy_byte_loop,   src, dst, length),
+               bench_copy(copy_my_memcopy,  src, dst, length),
+               bench_copy(copy_libc_memcpy, src, dst, length));
+    }
+
+    PRINTF("\n*** my_reverse THROUGHPUT (GB/s) ***\n\n");
+    PRINTF("%12s %12s %12s\n", "bytes", "byte_loop", "my_reverse");
+    for (length = BENCH_MIN_SIZE; length <= BENCH_MAX_SIZE; length *= 2){
+        PRINTF("%12lu %12.2f %12.2f\n", (unsigned long)length,
+               bench_copy(reverse_byte_loop,  src, dst, length),
+               bench_copy(reverse_my_reverse, src, dst, length));
+    }
+
+    {
+        static uint64_t pool_storage[MEM_POOL_STORAGE_BYTES(BENCH_ALLOC_WORDS, BENCH_POOL_BLOCKS) /
+                                         sizeof(uint64_t)];
+        mem_pool_t pool;
+        mem_arena_t arena;
+
+        PRINTF("\n*** reserve_words + free_words LATENCY (ns/pair) ***\n\n");
+        PRINTF("%12s %12.2f\n", "malloc", bench_alloc(BENCH_ALLOC_WORDS, NULL));
+
+        arena_init(&arena, src, BENCH_MAX_SIZE);
+        arena_install(&arena);
+        PRINTF("%12s %12.2f\n", "arena", bench_alloc(BENCH_ALLOC_WORDS, &arena));
+        arena_install(NULL);
+
+        pool_init(&pool, (uint8_t *)pool_storage, sizeof(pool_storage), BENCH_ALLOC_WORDS,
+                  BENCH_POOL_BLOCKS);
+        pool_install(&pool, 1);
+        PRINTF("%12s %12.2f\n", "pool", bench_alloc(BENCH_ALLOC_WORDS, NULL));
+        pool_install(NULL, 0);
+    }
+
+    {
+        int32_t * inputs = (int32_t *)src;          // reuse the copy buffer
+        uint32_t seed = 2463534242UL;
+        unsigned long i;
+
+        for (i=0; i<BENCH_ITOA_COUNT; i++){         // xorshift32 - full 32-bit range
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            inputs[i] = (int32_t)seed;
+        }
+
+        PRINTF("\n*** base 10 integer to text, random 32-bit inputs (ns/call) ***\n\n");
+        PRINTF("%12s %12.2f\n", "digit_loop", bench_itoa(itoa_digit_loop, inputs));
+        PRINTF("%12s %12.2f\n", "my_itoa",    bench_itoa(itoa_my_itoa,    inputs));
+        PRINTF("%12s %12.2f\n", "snprintf",   bench_itoa(itoa_snprintf,   inputs));
+
+        for (i=0; i<BENCH_ITOA_COUNT; i++){         // same inputs as text
+            my_itoa(inputs[i], dst + (i * BENCH_ATOI_STRIDE), 10);
+        }
+        PRINTF("\n*** base 10 text to integer, random 32-bit inputs (ns/call) ***\n\n");
+        PRINTF("%12s %12.2f\n", "my_atoi",    bench_atoi(dst, 0));
+        PRINTF("%12s %12.2f\n", "strtol",     bench_atoi(dst, 1));
+    }
+
+    {
+        uint8_t * input   = src;                    // 64 MB - 8 byte items up to 8M
+        uint8_t * data    = dst;
+        size_t t;
+        size_t count;
+
+        sort_scratch = (uint8_t *)malloc(BENCH_SORT_MAX * sizeof(uint64_t));
+        if (sort_scratch == NULL) goto done;
+        PRINTF("\n*** stats_sort (LSD radix) vs qsort, random keys (ns/item) ***\n\n");
+        PRINTF("%8s %12s %12s %12s %12s\n", "type", "items", "stats_sort", "qsort", "speedup");
+        for (t=0; t<(sizeof(bench_sort_types) / sizeof(bench_sort_types[0])); t++){
+            const bench_sort_type_t * type = &bench_sort_types[t];
+            type->fill(input, BENCH_SORT_MAX);
+            for (count = BENCH_SORT_MIN; count <= BENCH_SORT_MAX; count *= 16){
+                double radix = bench_sort(type, input, data, sort_scratch, count, 0);
+                double libc  = bench_sort(type, input, data, sort_scratch, count, 1);
+                PRINTF("%8s %12lu %12.2f %12.2f %12.2f\n", type->name, (unsigned long)count,
+                       radix, libc, libc / radix);
+            }
+        }
+    }
+
+    free(src);                                      // copy buffers done - room for the rest
+    free(dst);
+    free(sort_scratch);
+    src = dst = sort_scratch = NULL;
+
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        uint32_t seed = 2463534242UL;
+        unsigned int threads;
+        double single;
+        size_t i;
+
+        stats_data = (uint8_t *)malloc(BENCH_STATS_BYTES);
+        if (stats_data == NULL) goto done;
+        for (i=0; i<BENCH_STATS_BYTES; i++){        // xorshift32 - low byte
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            stats_data[i] = (uint8_t)seed;
+        }
+        if (cpus < 1) cpus = 1;
+
+        PRINTF("\n*** compute_statistics_parallel, %lu MB (GB/s) ***\n\n",
+               (unsigned long)(BENCH_STATS_BYTES >> 20));
+        PRINTF("%12s %12s %12s\n", "threads", "GB/s", "speedup");
+        single = bench_stats(stats_data, BENCH_STATS_BYTES, 1);
+        PRINTF("%12u %12.2f %12.2f\n", 1U, single, 1.0);
+        for (threads = 2; threads <= (unsigned int)cpus; threads *= 2){
+            double rate = bench_stats(stats_data, BENCH_STATS_BYTES, threads);
+            PRINTF("%12u %12.2f %12.2f\n", threads, rate, rate / single);
+        }
+        if ((threads / 2) != (unsigned int)cpus){   // all CPUs, if not a power of 2
+            double rate = bench_stats(stats_data, BENCH_STATS_BYTES, (unsigned int)cpus);
+            PRINTF("%12u %12.2f %12.2f\n", (unsigned int)cpus, rate, rate / single);
+        }
+        free(stats_data);
+        stats_data = NULL;
+    }
+
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        uint32_t seed = 2463534242UL;
+        unsigned int threads;
+        double single;
+        size_t i;
+
+        psort_input   = (int32_t *)malloc(BENCH_PSORT_ITEMS * sizeof(int32_t));
+        psort_data    = (int32_t *)malloc(BENCH_PSORT_ITEMS * sizeof(int32_t));
+        psort_scratch = (int32_t *)malloc(BENCH_PSORT_ITEMS * sizeof(int32_t));
+        if ((psort_input == NULL) || (psort_data == NULL) || (psort_scratch == NULL)) goto done;
+        for (i=0; i<BENCH_PSORT_ITEMS; i++){        // xorshift32 - full 32-bit range
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            psort_input[i] = (int32_t)seed;
+        }
+        if (cpus < 1) cpus = 1;
+
+        PRINTF("\n*** sort_parallel_i32, %lu random items (s) ***\n\n", (unsigned long)BENCH_PSORT_ITEMS);
+        PRINTF("%12s %12s %12s\n", "threads", "seconds", "speedup");
+        PRINTF("%12s %12.3f\n", "radix",
+               bench_psort(psort_input, psort_data, psort_scratch, BENCH_PSORT_ITEMS, NULL));
+        single = 0.0;
+        for (threads = 1; ; threads *= 2){
+            task_pool_t * pool;
+            double seconds;
+
+            if (threads > (unsigned int)cpus) threads = (unsigned int)cpus;
+            pool = task_pool_create(threads);
+            seconds = bench_psort(psort_input, psort_data, psort_scratch, BENCH_PSORT_ITEMS, pool);
+            task_pool_destroy(pool);
+            if (single == 0.0) single = seconds;
+            PRINTF("%12u %12.3f %12.2f\n", threads, seconds, single / seconds);
+            if (threads == (unsigned int)cpus) break;
+        }
+    }
+    ret = 0;
+
+done:
+    free(src);                                      // free(NULL) is a no-op
+    free(dst);
+    free(sort_scratch);
+    free(stats_data);
+    free(psort_input);
+    free(psort_data);
+    free(psort_scratch);
+    return ret;
+}
+
+
+
+int main(int argc, char * argv[]){
+    const char * mode   = (argc > 1) ? argv[1] : "text";
+    const char * filter = (argc > 2) ? argv[2] : NULL;
+
+    if (strcmp(mode, "text") == 0)   return bench_suite(BENCH_TEXT, filter);
+    if (strcmp(mode, "csv") == 0)    return bench_suite(BENCH_CSV,  filter);
+    if (strcmp(mode, "json") == 0)   return bench_suite(BENCH_JSON, filter);
+    if (strcmp(mode, "tables") == 0) return bench_tables();
+
+    fprintf(stderr, "Use: %s [text | csv | json | tables] [filter]\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,927 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <bench_suite.c>
+ * @brief  <Microbenchmark suite of the public memory, data and stats functions>
+ *
+ * <This file contains the cases of the microbenchmark suite (see bench_suite.h).
+ *  A case is a kernel - a small function making one call of the function under
+ *  test - and a bench_case_t holding the arguments of that call. bench_run
+ *  times the kernel and prints one result line.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "platform.h"
+#include "memory.h"
+#include "data.h"
+#include "stats.h"
+#include "cpu_dispatch.h"
+#include "bench_suite.h"
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC  (1)
+#else
+#define BENCH_HAVE_TSC  (0)
+#endif
+
+#define BENCH_ALIGN         (64UL)              // buffers start on a cache line
+#define BENCH_TABLE_SIZE    (1024UL)            // inputs of the data.h cases (power of 2)
+#define BENCH_TEXT_STRIDE   (36UL)              // bytes per string - base 2 with prefix
+#define BENCH_ALLOC_WORDS   (8UL)               // words per reserve_words call
+#define BENCH_POOL_BLOCKS   (64UL)              // blocks of the pool cases
+#if defined (VERBOSE)
+#define BENCH_PRINTS_ARRAY  (1)                 // print_array prints the data set
+#else
+#define BENCH_PRINTS_ARRAY  (0)                 // print_array does nothing
+#endif
+
+typedef struct bench_case bench_case_t;
+
+typedef void (*bench_kernel_t)(bench_case_t * c);
+
+/* Arguments of one case - see bench_run */
+struct bench_case {
+    const char *  function;                     // public function(s) called by the kernel
+    char          variant[24];                  // extra argument, e.g. "base=16"
+    const char *  overlap;                      // "none", "forward", "backward" or "-"
+    size_t        bytes;                        // bytes processed per call, 0 if none
+    size_t        length;                       // length argument of the call
+    unsigned long param;                        // kernel specific (base, words, ...)
+    unsigned long index;                        // kernel specific running counter
+    uint8_t *     src;
+    uint8_t *     dst;
+    void *        state;                        // kernel specific (arena, pool, ...)
+};
+
+/* Median time of one case */
+typedef struct {
+    unsigned long batch;                        // calls per sample
+    unsigned int  samples;
+    double        ns;                           // ns per call
+    double        cycles;                       // cycles per call (0 without TSC)
+} bench_stat_t;
+
+/* Settings and progress of one bench_suite call */
+typedef struct {
+    bench_format_t format;
+    const char *   filter;
+    unsigned long  cases;                       // cases printed so far
+} bench_context_t;
+
+static volatile uint8_t bench_sink;             // keeps results alive
+
+static const size_t bench_sizes[] = {
+    16, 64, 256, 1024, 4096, 16384, 65536, 262144, 1048576, BENCH_SUITE_MAX_BYTES
+};
+
+static const size_t bench_stats_sizes[] = { 64, 4096, 65536, 1048576 };
+
+/* src / dst address % BENCH_ALIGN of the alignment sweep */
+static const unsigned int bench_aligns[][2] = { {0, 0}, {1, 3} };
+
+static const char * const bench_overlaps[] = { "none", "forward", "backward" };
+
+#define BENCH_COUNT(array)  (sizeof(array) / sizeof((array)[0]))
+
+
+
+/*------------------- bench_now ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Returns a monotonic time stamp in nanoseconds
+ *-----------------------------------------------------------------------------*/
+static double bench_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+
+
+/*------------------- bench_cycles ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Returns the time stamp counter, 0 on CPUs without one
+ *-----------------------------------------------------------------------------*/
+static uint64_t bench_cycles(void){
+#if BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+
+/*------------------- bench_median ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Returns the median of count (<= BENCH_MAX_SAMPLES) values
+ *-----------------------------------------------------------------------------*/
+static double bench_median(const double * values, unsigned int count){
+    double sorted[BENCH_MAX_SAMPLES];
+    unsigned int i, j;
+
+    if (count == 0) return 0.0;
+    for (i=0; i<count; i++){                    // insertion sort - few values
+        double value = values[i];
+        for (j=i; (j > 0) && (sorted[j-1] > value); j--){
+            sorted[j] = sorted[j-1];
+        }
+        sorted[j] = value;
+    }
+    if (count & 1U) return sorted[count / 2];
+    return (sorted[(count / 2) - 1] + sorted[count / 2]) / 2.0;
+}
+
+
+
+/*------------------- bench_sample ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Runs the kernel batch times, returns the ns and cycles taken
+ *-----------------------------------------------------------------------------*/
+static double bench_sample(bench_case_t * c, bench_kernel_t kernel, unsigned long batch,
+                           double * cycles){
+    unsigned long i;
+    uint64_t cycles_start;
+    double start;
+
+    start = bench_now();
+    cycles_start = bench_cycles();
+    for (i=0; i<batch; i++){
+        kernel(c);
+    }
+    *cycles = (double)(bench_cycles() - cycles_start);
+    return bench_now() - start;
+}
+
+
+
+/*------------------- bench_measure --------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Finds the batch size, then samples until the median ns per call is stable
+ *-----------------------------------------------------------------------------*/
+static void bench_measure(bench_case_t * c, bench_kernel_t kernel, bench_stat_t * stat){
+    double ns[BENCH_MAX_SAMPLES];
+    double cycles[BENCH_MAX_SAMPLES];
+    double elapsed, spent = 0.0, median, previous = 0.0;
+    unsigned long batch = 1;
+    unsigned int count = 0, stable = 0;
+
+    kernel(c);                                  // warm up caches and page tables
+    while ((bench_sample(c, kernel, batch, &cycles[0]) < BENCH_SAMPLE_NS) &&
+           (batch < (1UL << 30))){
+        batch *= 2;
+    }
+
+    while ((count < BENCH_MAX_SAMPLES) && (spent < BENCH_CASE_NS)){
+        elapsed = bench_sample(c, kernel, batch, &cycles[count]);
+        spent += elapsed;
+        ns[count] = elapsed / (double)batch;
+        cycles[count] /= (double)batch;
+        count++;
+
+        median = bench_median(ns, count);
+        if ((count > 1) && ((median - previous) <= (previous * (BENCH_STABLE_PERCENT / 100.0))) &&
+                           ((previous - median) <= (previous * (BENCH_STABLE_PERCENT / 100.0)))){
+            stable++;
+        }else{
+            stable = 0;
+        }
+        previous = median;
+        if ((count >= BENCH_MIN_SAMPLES) && (stable >= BENCH_STABLE_SAMPLES)) break;
+    }
+
+    stat->batch   = batch;
+    stat->samples = count;
+    stat->ns      = bench_median(ns, count);
+    stat->cycles  = bench_median(cycles, count);
+}
+
+
+
+/*------------------- bench_quiet ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * saved < 0: sends stdout to /dev/null and returns the saved stdout (-1 on
+ * failure). saved >= 0: puts the saved stdout back and returns -1.
+ *-----------------------------------------------------------------------------*/
+static int bench_quiet(int saved){
+    int null_fd;
+
+    fflush(stdout);
+    if (saved >= 0){
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+        return -1;
+    }
+    null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd < 0) return -1;
+    saved = dup(STDOUT_FILENO);
+    if (saved >= 0) dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+    return saved;
+}
+
+
+
+/*------------------- bench_print ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Prints the result of one case in the format of the context
+ *-----------------------------------------------------------------------------*/
+static void bench_print(bench_context_t * ctx, const bench_case_t * c, const bench_stat_t * stat){
+    unsigned int src_align = (c->src != NULL) ? (unsigned int)((uintptr_t)c->src % BENCH_ALIGN) : 0;
+    unsigned int dst_align = (c->dst != NULL) ? (unsigned int)((uintptr_t)c->dst % BENCH_ALIGN) : 0;
+    double rate  = (c->bytes != 0) ? ((double)c->bytes * 1e9 / stat->ns) : 0.0;       // bytes/s
+    double cpb   = (c->bytes != 0) ? (stat->cycles / (double)c->bytes) : 0.0;         // cycles/byte
+    unsigned char has_rate   = (c->bytes != 0);
+    unsigned char has_cycles = BENCH_HAVE_TSC;
+
+    if (ctx->format == BENCH_CSV){
+        if (ctx->cases == 0){
+            PRINTF("function,variant,bytes,src_align,dst_align,overlap,batch,samples,"
+                   "ns_per_op,bytes_per_s,cycles_per_op,cycles_per_byte\n");
+        }
+        PRINTF("%s,%s,%lu,%u,%u,%s,%lu,%u,%.3f,", c->function, c->variant,
+               (unsigned long)c->bytes, src_align, dst_align, c->overlap,
+               stat->batch, stat->samples, stat->ns);
+        if (has_rate) PRINTF("%.0f", rate);
+        PRINTF(",");
+        if (has_cycles) PRINTF("%.3f", stat->cycles);
+        PRINTF(",");
+        if (has_rate && has_cycles) PRINTF("%.4f", cpb);
+        PRINTF("\n");
+    }else if (ctx->format == BENCH_JSON){
+        PRINTF("%s\n    {\"function\": \"%s\", \"variant\": \"%s\", \"bytes\": %lu, "
+               "\"src_align\": %u, \"dst_align\": %u, \"overlap\": \"%s\", \"batch\": %lu, "
+               "\"samples\": %u, \"ns_per_op\": %.3f, ",
+               (ctx->cases == 0) ? "" : ",", c->function, c->variant,
+               (unsigned long)c->bytes, src_align, dst_align, c->overlap,
+               stat->batch, stat->samples, stat->ns);
+        if (has_rate) PRINTF("\"bytes_per_s\": %.0f, ", rate);
+        else          PRINTF("\"bytes_per_s\": null, ");
+        if (has_cycles) PRINTF("\"cycles_per_op\": %.3f, ", stat->cycles);
+        else            PRINTF("\"cycles_per_op\": null, ");
+        if (has_rate && has_cycles) PRINTF("\"cycles_per_byte\": %.4f}", cpb);
+        else                        PRINTF("\"cycles_per_byte\": null}");
+    }else{
+        if (ctx->cases == 0){
+            PRINTF("\n*** MICROBENCHMARKS (median of samples, %s kernels) ***\n\n",
+                   cpu_isa_name(cpu_isa()));
+            PRINTF("%-34s %-12s %9s %5s %-8s %11s %9s %9s %9s\n", "function", "variant",
+                   "bytes", "align", "overlap", "ns/op", "GB/s", "cyc/op", "cyc/B");
+        }
+        PRINTF("%-34s %-12s %9lu %2u/%-2u %-8s %11.2f ", c->function, c->variant,
+               (unsigned long)c->bytes, src_align, dst_align, c->overlap, stat->ns);
+        if (has_rate) PRINTF("%9.3f ", rate / 1e9);
+        else          PRINTF("%9s ", "-");
+        if (has_cycles) PRINTF("%9.1f ", stat->cycles);
+        else            PRINTF("%9s ", "-");
+        if (has_rate && has_cycles) PRINTF("%9.3f\n", cpb);
+        else                        PRINTF("%9s\n", "-");
+    }
+    fflush(stdout);
+    ctx->cases++;
+}
+
+
+
+/*------------------- bench_run ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Times one case (if its function passes the filter) and prints the result.
+ * quiet = 1 sends the output of the kernel to /dev/null.
+ *-----------------------------------------------------------------------------*/
+static void bench_run(bench_context_t * ctx, bench_case_t * c, bench_kernel_t kernel,
+                      unsigned char quiet){
+    bench_stat_t stat;
+    int saved = -1;
+
+    if ((ctx->filter != NULL) && (strstr(c->function, ctx->filter) == NULL)) return;
+
+    if (quiet) saved = bench_quiet(-1);
+    bench_measure(c, kernel, &stat);
+    if (quiet) bench_quiet(saved);
+    bench_print(ctx, c, &stat);
+}
+
+
+
+/*------------------- bench_setup ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Starts a case of function with no arguments
+ *-----------------------------------------------------------------------------*/
+static void bench_setup(bench_case_t * c, const char * function){
+    memset(c, 0, sizeof(*c));
+    c->function = function;
+    c->overlap  = "-";
+}
+
+
+
+/*------------------- bench_place ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Points src / dst of a copy case into area (4 * BENCH_SUITE_MAX_BYTES +
+ * 2 * BENCH_ALIGN bytes, aligned): src in the second quarter, dst in the
+ * third quarter (no overlap) or half a length above / below src.
+ *-----------------------------------------------------------------------------*/
+static void bench_place(bench_case_t * c, uint8_t * area, size_t length,
+                        unsigned int src_align, unsigned int dst_align, const char * overlap){
+    uint8_t * src = area + BENCH_SUITE_MAX_BYTES;
+
+    c->overlap = overlap;
+    c->length  = length;
+    c->bytes   = length;
+    c->src     = src + src_align;
+    if (strcmp(overlap, "forward") == 0){       // dst above src - copy from the end
+        c->dst = src + (length / 2) + dst_align;
+    }else if (strcmp(overlap, "backward") == 0){
+        c->dst = src - (length / 2) + dst_align;
+    }else{
+        c->dst = src + BENCH_SUITE_MAX_BYTES + BENCH_ALIGN + dst_align;
+    }
+}
+
+
+
+/*------------------- memory.h kernels -----------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *-----------------------------------------------------------------------------*/
+static void k_set_value(bench_case_t * c){
+    set_value((char *)c->dst, (unsigned int)(c->index++ & 63UL), 0x55);
+}
+
+static void k_clear_value(bench_case_t * c){
+    clear_value((char *)c->dst, (unsigned int)(c->index++ & 63UL));
+}
+
+static void k_get_value(bench_case_t * c){
+    bench_sink ^= (uint8_t)get_value((char *)c->src, (unsigned int)(c->index++ & 63UL));
+}
+
+static void k_set_all(bench_case_t * c){
+    set_all((char *)c->dst, 0x55, (unsigned int)c->length);
+}
+
+static void k_clear_all(bench_case_t * c){
+    clear_all((char *)c->dst, (unsigned int)c->length);
+}
+
+static void k_memmove(bench_case_t * c){
+    my_memmove(c->src, c->dst, c->length);
+}
+
+static void k_memmove_clear(bench_case_t * c){
+    my_memmove_clear(c->src, c->dst, c->length);
+}
+
+static void k_memcopy(bench_case_t * c){
+    my_memcopy(c->src, c->dst, c->length);
+}
+
+static void k_memset(bench_case_t * c){
+    my_memset(c->dst, c->length, 0x55);
+}
+
+static void k_memzero(bench_case_t * c){
+    my_memzero(c->dst, c->length);
+}
+
+static void k_memset_pattern(bench_case_t * c){
+    static const uint8_t pattern[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF };
+    my_memset_pattern(c->dst, c->length, pattern, c->param);
+}
+
+static void k_reverse(bench_case_t * c){
+    my_reverse(c->src, c->length);
+}
+
+static void k_reserve_words(bench_case_t * c){
+    int32_t * block = reserve_words(c->param);
+    block[0] = (int32_t)c->index++;
+    bench_sink ^= (uint8_t)block[0];
+    free_words((uint32_t *)block);
+    if (c->state != NULL) arena_reset((mem_arena_t *)c->state);   // arena: free is a no-op
+}
+
+static void k_arena_init(bench_case_t * c){
+    arena_init((mem_arena_t *)c->state, c->dst, c->length);
+}
+
+static void k_arena_create(bench_case_t * c){
+    mem_arena_t arena;
+    if (arena_create(&arena, c->length) != NULL) arena_destroy(&arena);
+}
+
+static void k_arena_reserve_words(bench_case_t * c){
+    bench_sink ^= (uint8_t)(uintptr_t)arena_reserve_words((mem_arena_t *)c->state, c->param);
+    arena_reset((mem_arena_t *)c->state);
+}
+
+static void k_arena_install(bench_case_t * c){
+    arena_install(arena_install((mem_arena_t *)c->state));
+}
+
+static void k_pool_init(bench_case_t * c){
+    pool_init((mem_pool_t *)c->state, c->dst, c->length, BENCH_ALLOC_WORDS, c->param);
+}
+
+static void k_pool_reserve(bench_case_t * c){
+    pool_release((mem_pool_t *)c->state, pool_reserve((mem_pool_t *)c->state));
+}
+
+static void k_pool_owns(bench_case_t * c){
+    bench_sink ^= pool_owns((mem_pool_t *)c->state, c->dst + (c->index++ & 63UL));
+}
+
+static void k_pool_install(bench_case_t * c){
+    pool_install((mem_pool_t *)c->state, 1);
+    pool_install(NULL, 0);
+}
+
+
+
+/*------------------- suite_memory ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Cases of memory.h. area: see bench_place.
+ *-----------------------------------------------------------------------------*/
+static void suite_memory(bench_context_t * ctx, uint8_t * area){
+    static const struct {
+        const char *   function;
+        bench_kernel_t kernel;
+    } copies[] = {
+        { "my_memmove",       k_memmove       },
+        { "my_memmove_clear", k_memmove_clear },
+        { "my_memcopy",       k_memcopy       },
+    }, fills[] = {
+        { "set_all",          k_set_all       },
+        { "clear_all",        k_clear_all     },
+        { "my_memset",        k_memset        },
+        { "my_memzero",       k_memzero       },
+        { "my_reverse",       k_reverse       },
+    };
+    mem_arena_t arena;
+    mem_pool_t pool;
+    bench_case_t c;
+    size_t f, s, a, o, p;
+
+    bench_setup(&c, "set_value");
+    c.dst = area;
+    c.bytes = 1;
+    bench_run(ctx, &c, k_set_value, 0);
+    bench_setup(&c, "clear_value");
+    c.dst = area;
+    c.bytes = 1;
+    bench_run(ctx, &c, k_clear_value, 0);
+    bench_setup(&c, "get_value");
+    c.src = area;
+    c.bytes = 1;
+    bench_run(ctx, &c, k_get_value, 0);
+
+    for (f=0; f<BENCH_COUNT(copies); f++){      // size x alignment x overlap
+        for (s=0; s<BENCH_COUNT(bench_sizes); s++){
+            for (a=0; a<BENCH_COUNT(bench_aligns); a++){
+                for (o=0; o<BENCH_COUNT(bench_overlaps); o++){
+                    bench_setup(&c, copies[f].function);
+                    bench_place(&c, area, bench_sizes[s], bench_aligns[a][0],
+                                bench_aligns[a][1], bench_overlaps[o]);
+                    bench_run(ctx, &c, copies[f].kernel, 0);
+                }
+            }
+        }
+    }
+
+    for (f=0; f<BENCH_COUNT(fills); f++){       // size x alignment, one buffer
+        for (s=0; s<BENCH_COUNT(bench_sizes); s++){
+            for (a=0; a<BENCH_COUNT(bench_aligns); a++){
+                bench_setup(&c, fills[f].function);
+                bench_place(&c, area, bench_sizes[s], bench_aligns[a][1],
+                            bench_aligns[a][1], "-");
+                if (fills[f].kernel == k_reverse) c.dst = NULL;
+                else                              c.src = NULL;
+                bench_run(ctx, &c, fills[f].kernel, 0);
+            }
+        }
+    }
+
+    for (p=1; p<=8; p*=2){                      // size x pattern length
+        for (s=0; s<BENCH_COUNT(bench_sizes); s++){
+            bench_setup(&c, "my_memset_pattern");
+            bench_place(&c, area, bench_sizes[s], 0, 0, "-");
+            c.src = NULL;
+            c.param = p;
+            snprintf(c.variant, sizeof(c.variant), "pattern=%lu", (unsigned long)p);
+            bench_run(ctx, &c, k_memset_pattern, 0);
+        }
+    }
+
+    /* Allocators - one block of BENCH_ALLOC_WORDS words per call */
+    bench_setup(&c, "reserve_words+free_words");
+    c.param = BENCH_ALLOC_WORDS;
+    strcpy(c.variant, "malloc");
+    bench_run(ctx, &c, k_reserve_words, 0);
+
+    arena_init(&arena, area, BENCH_SUITE_MAX_BYTES);
+    arena_install(&arena);
+    strcpy(c.variant, "arena");
+    c.state = &arena;
+    bench_run(ctx, &c, k_reserve_words, 0);
+    arena_install(NULL);
+
+    pool_init(&pool, area, BENCH_SUITE_MAX_BYTES, BENCH_ALLOC_WORDS, BENCH_POOL_BLOCKS);
+    pool_install(&pool, 1);
+    strcpy(c.variant, "pool");
+    c.state = NULL;
+    bench_run(ctx, &c, k_reserve_words, 0);
+    pool_install(NULL, 0);
+
+    bench_setup(&c, "arena_init");
+    c.state = &arena;
+    c.dst = area;
+    c.length = BENCH_SUITE_MAX_BYTES;
+    bench_run(ctx, &c, k_arena_init, 0);
+
+    for (s=0; s<BENCH_COUNT(bench_sizes); s+=3){
+        bench_setup(&c, "arena_create+arena_destroy");
+        c.length = bench_sizes[s];
+        snprintf(c.variant, sizeof(c.variant), "size=%lu", (unsigned long)bench_sizes[s]);
+        bench_run(ctx, &c, k_arena_create, 0);
+    }
+
+    arena_init(&arena, area, BENCH_SUITE_MAX_BYTES);
+    bench_setup(&c, "arena_reserve_words+arena_reset");
+    c.state = &arena;
+    c.param = BENCH_ALLOC_WORDS;
+    bench_run(ctx, &c, k_arena_reserve_words, 0);
+    bench_setup(&c, "arena_install");
+    c.state = &arena;
+    bench_run(ctx, &c, k_arena_install, 0);
+
+    for (p=BENCH_POOL_BLOCKS; p<=(BENCH_POOL_BLOCKS*256); p*=16){
+        bench_setup(&c, "pool_init");
+        c.state = &pool;
+        c.dst = area;
+        c.length = BENCH_SUITE_MAX_BYTES;
+        c.param = p;
+        snprintf(c.variant, sizeof(c.variant), "blocks=%lu", (unsigned long)p);
+        bench_run(ctx, &c, k_pool_init, 0);
+    }
+
+    pool_init(&pool, area, BENCH_SUITE_MAX_BYTES, BENCH_ALLOC_WORDS, BENCH_POOL_BLOCKS);
+    bench_setup(&c, "pool_reserve+pool_release");
+    c.state = &pool;
+    bench_run(ctx, &c, k_pool_reserve, 0);
+    bench_setup(&c, "pool_owns");
+    c.state = &pool;
+    c.dst = area;
+    bench_run(ctx, &c, k_pool_owns, 0);
+    bench_setup(&c, "pool_install");
+    c.state = &pool;
+    bench_run(ctx, &c, k_pool_install, 0);
+}
+
+
+
+/*------------------- data.h kernels -------------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * src holds BENCH_TABLE_SIZE inputs (int32_t or strings BENCH_TEXT_STRIDE apart)
+ *-----------------------------------------------------------------------------*/
+static void k_itoa(bench_case_t * c){
+    const int32_t * inputs = (const int32_t *)c->src;
+    my_itoa(inputs[c->index++ & (BENCH_TABLE_SIZE - 1)], c->dst, (uint32_t)c->param);
+}
+
+static void k_itoa_batch(bench_case_t * c){
+    uint32_t * offsets = (uint32_t *)c->state;                  // bytes is the exact size
+    bench_sink ^= (uint8_t)my_itoa_batch((const int32_t *)c->src, c->length, (uint32_t)c->param,
+                                         c->dst, c->bytes, offsets);
+}
+
+static void k_atoi(bench_case_t * c){
+    uint8_t * text = c->src + ((c->index++ & (BENCH_TABLE_SIZE - 1)) * BENCH_TEXT_STRIDE);
+    bench_sink ^= (uint8_t)my_atoi(text, 0, (uint32_t)c->param);
+}
+
+static void k_atoi_parse(bench_case_t * c){
+    uint8_t * text = c->src + ((c->index++ & (BENCH_TABLE_SIZE - 1)) * BENCH_TEXT_STRIDE);
+    int32_t value;
+    my_atoi_parse(text, (uint32_t)c->param, &value, NULL);
+    bench_sink ^= (uint8_t)value;
+}
+
+
+
+/*------------------- suite_data -----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Cases of data.h - random 32-bit inputs, bases 2, 10 and 16. my_itoa_batch
+ * converts the whole table per call, my_itoa one input.
+ *-----------------------------------------------------------------------------*/
+static void suite_data(bench_context_t * ctx, uint8_t * area){
+    static const uint32_t bases[] = { 2, 10, 16 };
+    int32_t * inputs = (int32_t *)area;
+    uint8_t * text   = area + (BENCH_TABLE_SIZE * sizeof(int32_t));
+    uint8_t * packed = text + (BENCH_TABLE_SIZE * BENCH_TEXT_STRIDE) + BENCH_ALIGN;
+    uint32_t * offsets = (uint32_t *)(packed + (BENCH_TABLE_SIZE * BENCH_TEXT_STRIDE));
+    uint32_t seed = 2463534242UL;
+    bench_case_t c;
+    size_t b, i;
+
+    for (i=0; i<BENCH_TABLE_SIZE; i++){         // xorshift32 - full 32-bit range
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        inputs[i] = (int32_t)seed;
+    }
+
+    for (b=0; b<BENCH_COUNT(bases); b++){
+        for (i=0; i<BENCH_TABLE_SIZE; i++){
+            my_itoa(inputs[i], text + (i * BENCH_TEXT_STRIDE), bases[b]);
+        }
+
+        bench_setup(&c, "my_itoa");
+        c.src = (uint8_t *)inputs;
+        c.dst = text + (BENCH_TABLE_SIZE * BENCH_TEXT_STRIDE);
+        c.param = bases[b];
+        snprintf(c.variant, sizeof(c.variant), "base=%u", (unsigned int)bases[b]);
+        bench_run(ctx, &c, k_itoa, 0);
+
+        bench_setup(&c, "my_itoa_batch");
+        c.src = (uint8_t *)inputs;
+        c.dst = packed;
+        c.state = offsets;
+        c.length = BENCH_TABLE_SIZE;
+        c.bytes = my_itoa_batch(inputs, BENCH_TABLE_SIZE, bases[b], NULL, 0, NULL);
+        c.param = bases[b];
+        snprintf(c.variant, sizeof(c.variant), "base=%u", (unsigned int)bases[b]);
+        bench_run(ctx, &c, k_itoa_batch, 0);
+
+        bench_setup(&c, "my_atoi");
+        c.src = text;
+        c.param = bases[b];
+        snprintf(c.variant, sizeof(c.variant), "base=%u", (unsigned int)bases[b]);
+        bench_run(ctx, &c, k_atoi, 0);
+
+        bench_setup(&c, "my_atoi_parse");
+        c.src = text;
+        c.param = bases[b];
+        snprintf(c.variant, sizeof(c.variant), "base=%u", (unsigned int)bases[b]);
+        bench_run(ctx, &c, k_atoi_parse, 0);
+    }
+}
+
+
+
+/*------------------- stats.h kernels ------------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * src holds length random bytes, state the bench_stats_state_t
+ *-----------------------------------------------------------------------------*/
+typedef struct {
+    stats_result_t        result;               // statistics of src
+    stats_acc_t           acc[2];
+    stats_minmaxsum_t     mms;
+    stats_print_options_t options;
+} bench_stats_state_t;
+
+#define STATS_STATE(c)  ((bench_stats_state_t *)(c)->state)
+
+static void k_print_statistics(bench_case_t * c){
+    print_statistics(c->src, c->length);
+}
+
+static void k_print_statistics_result(bench_case_t * c){
+    print_statistics_result(c->src, c->length, &STATS_STATE(c)->result);
+}
+
+static void k_compute_statistics(bench_case_t * c){
+    stats_result_t result;
+    compute_statistics(c->src, c->length, &result);
+    bench_sink ^= result.median;
+}
+
+static void k_stats_init(bench_case_t * c){
+    stats_init(&STATS_STATE(c)->acc[0]);
+}
+
+static void k_stats_push(bench_case_t * c){
+    stats_push(&STATS_STATE(c)->acc[0], c->src[c->index++ & 63UL]);
+}
+
+static void k_stats_push_block(bench_case_t * c){
+    stats_push_block(&STATS_STATE(c)->acc[0], c->src, c->length);
+}
+
+static void k_stats_merge(bench_case_t * c){
+    stats_merge(&STATS_STATE(c)->acc[0], &STATS_STATE(c)->acc[1]);
+}
+
+static void k_stats_snapshot(bench_case_t * c){
+    stats_snapshot(&STATS_STATE(c)->acc[1], &STATS_STATE(c)->result);
+}
+
+static void k_stats_value_at_rank(bench_case_t * c){
+    unsigned long rank = (c->index++ * 7919UL) % STATS_STATE(c)->result.count;
+    bench_sink ^= stats_value_at_rank(&STATS_STATE(c)->result, rank);
+}
+
+static void k_stats_percentile(bench_case_t * c){
+    bench_sink ^= stats_percentile(&STATS_STATE(c)->result, (unsigned int)(c->index++ % 101UL));
+}
+
+static void k_stats_print_install(bench_case_t * c){
+    stats_print_install(stats_print_install(&STATS_STATE(c)->options));
+}
+
+static void k_print_array(bench_case_t * c){
+    print_array(c->src, c->length);
+}
+
+static void k_find_median(bench_case_t * c){
+    bench_sink ^= find_median(c->src, c->length);
+}
+
+static void k_find_median_i32(bench_case_t * c){
+    int32_t median;
+
+    find_median_i32((int32_t *)c->dst, c->length, 0, &median);
+    bench_sink ^= (uint8_t)median;
+}
+
+static void k_find_min_max_sum(bench_case_t * c){
+    find_min_max_sum(c->src, c->length, &STATS_STATE(c)->mms);
+    bench_sink ^= STATS_STATE(c)->mms.maximum;
+}
+
+static void k_find_mean(bench_case_t * c){
+    bench_sink ^= (uint8_t)find_mean(c->src, c->length);
+}
+
+static void k_find_maximum(bench_case_t * c){
+    bench_sink ^= find_maximum(c->src, c->length);
+}
+
+static void k_find_minimum(bench_case_t * c){
+    bench_sink ^= find_minimum(c->src, c->length);
+}
+
+static void k_sort_array(bench_case_t * c){
+    memcpy(c->dst, c->src, c->length);          // sort fresh random data each call
+    sort_array(c->dst, c->length);
+}
+
+
+
+/*------------------- suite_stats ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Cases of stats.h - random bytes (int32_t for find_median_i32)
+ *-----------------------------------------------------------------------------*/
+static void suite_stats(bench_context_t * ctx, uint8_t * area){
+    static const struct {
+        const char *   function;
+        bench_kernel_t kernel;
+        unsigned char  quiet;
+        unsigned char  reads;                   // reads all of the data set
+    } scans[] = {
+        { "print_statistics",        k_print_statistics,        1, 1 },
+        { "print_statistics_result", k_print_statistics_result, 1, BENCH_PRINTS_ARRAY },
+        { "print_array",             k_print_array,             1, BENCH_PRINTS_ARRAY },
+        { "compute_statistics",      k_compute_statistics,      0, 1 },
+        { "stats_push_block",        k_stats_push_block,        0, 1 },
+        { "find_median",             k_find_median,             0, 1 },
+        { "find_min_max_sum",        k_find_min_max_sum,        0, 1 },
+        { "find_mean",               k_find_mean,               0, 1 },
+        { "find_maximum",            k_find_maximum,            0, 1 },
+        { "find_minimum",            k_find_minimum,            0, 1 },
+        { "sort_array",              k_sort_array,              0, 1 },
+    }, calls[] = {
+        { "stats_init",              k_stats_init,              0, 0 },
+        { "stats_push",              k_stats_push,              0, 1 },
+        { "stats_merge",             k_stats_merge,             0, 0 },
+        { "stats_snapshot",          k_stats_snapshot,          0, 0 },
+        { "stats_value_at_rank",     k_stats_value_at_rank,     0, 0 },
+        { "stats_percentile",        k_stats_percentile,        0, 0 },
+        { "stats_print_install",     k_stats_print_install,     0, 0 },
+    };
+    bench_stats_state_t state;
+    uint8_t * data = area;
+    uint8_t * copy = area + BENCH_SUITE_MAX_BYTES;
+    uint32_t seed = 2463534242UL;
+    bench_case_t c;
+    size_t f, s, i;
+
+    for (i=0; i<(2 * BENCH_SUITE_MAX_BYTES); i++){   // xorshift32 - low byte
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        data[i] = (uint8_t)seed;                // second half: int32_t items
+    }
+
+    memset(&state, 0, sizeof(state));
+    state.options.mode = STATS_PRINT_SUMMARY;
+    compute_statistics(data, bench_stats_sizes[1], &state.result);
+    stats_init(&state.acc[0]);
+    stats_init(&state.acc[1]);
+    stats_push_block(&state.acc[1], data, bench_stats_sizes[1]);
+
+    for (f=0; f<BENCH_COUNT(scans); f++){
+        for (s=0; s<BENCH_COUNT(bench_stats_sizes); s++){
+            bench_setup(&c, scans[f].function);
+            c.src    = data;
+            c.dst    = (scans[f].kernel == k_sort_array) ? (area + (2 * BENCH_SUITE_MAX_BYTES)) : NULL;
+            c.length = bench_stats_sizes[s];
+            c.bytes  = scans[f].reads ? bench_stats_sizes[s] : 0;
+            c.state  = &state;
+            if (scans[f].kernel == k_sort_array) strcpy(c.variant, "incl. copy");
+            bench_run(ctx, &c, scans[f].kernel, scans[f].quiet);
+        }
+    }
+
+    for (s=0; s<BENCH_COUNT(bench_stats_sizes); s++){   // median of a copy (malloc)
+        bench_setup(&c, "find_median_i32");
+        c.dst    = copy;
+        c.length = bench_stats_sizes[s] / sizeof(int32_t);
+        c.bytes  = bench_stats_sizes[s];
+        strcpy(c.variant, "copy");
+        bench_run(ctx, &c, k_find_median_i32, 0);
+    }
+
+    for (f=0; f<BENCH_COUNT(calls); f++){
+        bench_setup(&c, calls[f].function);
+        c.src   = data;
+        c.state = &state;
+        c.bytes = calls[f].reads;               // stats_push: one byte
+        bench_run(ctx, &c, calls[f].kernel, calls[f].quiet);
+    }
+}
+
+
+
+int bench_suite(bench_format_t format, const char * filter){
+    size_t size = (4 * BENCH_SUITE_MAX_BYTES) + (2 * BENCH_ALIGN);
+    uint8_t * buffer = (uint8_t *)malloc(size);
+    uint8_t * area;
+    bench_context_t ctx;
+
+    if (buffer == NULL) return 1;
+    area = buffer + ((BENCH_ALIGN - ((uintptr_t)buffer % BENCH_ALIGN)) % BENCH_ALIGN);
+    memset(buffer, 0x5A, size);
+
+    ctx.format = format;
+    ctx.filter = filter;
+    ctx.cases  = 0;
+
+    if (format == BENCH_JSON){
+        PRINTF("{\n  \"timer\": \"clock_gettime\",\n  \"cycles\": \"%s\",\n  \"isa\": \"%s\",\n"
+               "  \"results\": [", BENCH_HAVE_TSC ? "rdtsc" : "none", cpu_isa_name(cpu_isa()));
+    }
+    suite_memory(&ctx, area);
+    suite_data(&ctx, area);
+    suite_stats(&ctx, area);
+    if (format == BENCH_JSON){
+        PRINTF("\n  ]\n}\n");
+    }
+
+    free(buffer);
+    return 0;
+}
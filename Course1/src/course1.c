@@ -23,6 +23,10 @@
 #include "memory.h"
 #include "data.h"
 #include "stats.h"
+#include "stats_parallel.h"
+#include "stats_generic.h"
+#include "cpu_dispatch.h"
+#include "trace.h"
 
 int8_t test_data1() {
   uint8_t * ptr;
@@ -30,7 +34,7 @@ int8_t test_data1() {
   uint32_t digits;
   int32_t value;
 
-  PRINTF("\ntest_data1();\n");
+  TRACE("\ntest_data1();\n");
   ptr = (uint8_t*) reserve_words( DATA_SET_SIZE_W );
 
   if (! ptr )
@@ -41,8 +45,8 @@ int8_t test_data1() {
   digits = my_itoa( num, ptr, BASE_16);   
   value = my_atoi( ptr, digits, BASE_16);
   #ifdef VERBOSE
-  PRINTF("  Initial number: %d\n", num);
-  PRINTF("  Final Decimal number: %d\n", value);
+  TRACE("  Initial number: %d\n", num);
+  TRACE("  Final Decimal number: %d\n", value);
   #endif
   free_words( (uint32_t*)ptr );
 
@@ -59,7 +63,7 @@ int8_t test_data2() {
   uint32_t digits;
   int32_t value;
 
-  PRINTF("test_data2():\n");
+  TRACE("test_data2():\n");
   ptr = (uint8_t*) reserve_words( DATA_SET_SIZE_W );
 
   if (! ptr )
@@ -70,8 +74,8 @@ int8_t test_data2() {
   digits = my_itoa( num, ptr, BASE_10);
   value = my_atoi( ptr, digits, BASE_10);
   #ifdef VERBOSE
-  PRINTF("  Initial Decimal number: %d\n", num);
-  PRINTF("  Final Decimal number: %d\n", value);
+  TRACE("  Initial Decimal number: %d\n", num);
+  TRACE("  Final Decimal number: %d\n", value);
   #endif
   free_words( (uint32_t*)ptr );
 
@@ -82,6 +86,143 @@ int8_t test_data2() {
   return TEST_NO_ERROR;
 }
 
+int8_t test_itoa_batch() {
+  static const int32_t numbers[ITOA_BATCH_LENGTH] = { 0, 1, -1, 123456, -4096,
+                                                      INT32_MAX, INT32_MIN, 7 };
+  static const uint32_t bases[] = { 2, 7, 8, 10, 16 };
+  static uint8_t text[ITOA_BATCH_SIZE_B];
+  uint8_t single[ITOA_BATCH_STRING_B];
+  uint32_t offsets[ITOA_BATCH_LENGTH];
+  uint32_t b, i, j;
+  size_t size, used;
+  uint8_t length;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_itoa_batch()\n");
+
+  for (b = 0; b < (sizeof(bases) / sizeof(bases[0])); b++)
+  {
+    size = my_itoa_batch(numbers, ITOA_BATCH_LENGTH, bases[b], NULL, 0, NULL);
+
+    /* too small - nothing written */
+    text[0] = 0xA5;
+    if ((size == 0) || (size > ITOA_BATCH_SIZE_B) ||
+        (my_itoa_batch(numbers, ITOA_BATCH_LENGTH, bases[b], text, size - 1, offsets) !=
+         ITOA_BATCH_ERROR) ||
+        (text[0] != 0xA5))
+    {
+      ret = TEST_ERROR;
+      continue;
+    }
+
+    /* every string as my_itoa writes it, packed */
+    used = my_itoa_batch(numbers, ITOA_BATCH_LENGTH, bases[b], text, size, offsets);
+    if (used != size)
+    {
+      ret = TEST_ERROR;
+    }
+    for (i = 0, j = 0; i < ITOA_BATCH_LENGTH; i++)
+    {
+      length = my_itoa(numbers[i], single, bases[b]);
+      if (offsets[i] != j)
+      {
+        ret = TEST_ERROR;
+        break;
+      }
+      for (j = 0; j < length; j++)
+      {
+        if (text[offsets[i] + j] != single[j]) ret = TEST_ERROR;
+      }
+      j = offsets[i] + length;
+    }
+    if (j != size)
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  /* errors are told apart from an empty batch */
+  if ((my_itoa_batch(numbers, ITOA_BATCH_LENGTH, 17, text, ITOA_BATCH_SIZE_B, offsets) !=
+       ITOA_BATCH_ERROR) ||
+      (my_itoa_batch(numbers, ITOA_BATCH_LENGTH, 1, NULL, 0, NULL) != ITOA_BATCH_ERROR) ||
+      (my_itoa_batch(numbers, ITOA_BATCH_LENGTH, BASE_10, text, ITOA_BATCH_SIZE_B, NULL) !=
+       ITOA_BATCH_ERROR) ||
+      (my_itoa_batch(numbers, 0, 17, text, ITOA_BATCH_SIZE_B, offsets) != ITOA_BATCH_ERROR))
+  {
+    ret = TEST_ERROR;
+  }
+  text[0] = 0xA5;
+  if ((my_itoa_batch(numbers, 0, BASE_10, NULL, 0, NULL) != 0) ||
+      (my_itoa_batch(numbers, 0, BASE_10, text, 0, offsets) != 0) ||
+      (my_itoa_batch(numbers, 0, BASE_10, text, 0, NULL) != 0) ||     /* no offsets needed */
+      (text[0] != 0xA5))
+  {
+    ret = TEST_ERROR;
+  }
+  return ret;
+}
+
+/* One my_atoi_parse case - string, base and what the parser must return */
+typedef struct {
+  const char * text;
+  uint32_t base;
+  int32_t value;
+  size_t consumed;
+  uint8_t overflow;
+} atoi_parse_case_t;
+
+int8_t test_atoi_parse() {
+  static const atoi_parse_case_t cases[] = {
+    { "2147483647",   10, INT32_MAX,   10, 0 },
+    { "-2147483648",  10, INT32_MIN,   11, 0 },
+    { "2147483648",   10, INT32_MAX,   10, 1 },    /* one past the limits - saturated */
+    { "-2147483649",  10, INT32_MIN,   11, 1 },
+    { "99999999999x", 10, INT32_MAX,   11, 1 },
+    { "12z",          10, 12,           2, 0 },    /* stops at the first non-digit */
+    { "0b101",         2, 5,            5, 0 },
+    { "-0b11",         2, -3,           5, 0 },
+    { "0c17",          8, 15,           4, 0 },
+    { "0xFFFFFFFF",   16, -1,          10, 0 },    /* two's complement pattern */
+    { "0x80000000",   16, INT32_MIN,   10, 0 },
+    { "0x100000000",  16, INT32_MAX,   11, 1 },
+    { "-0x80000001",  16, INT32_MIN,   11, 1 },
+    { "ff",           16, 255,          2, 0 },
+    { "0x",           16, 0,            1, 0 },    /* no digit after the prefix */
+    { "0b2",           2, 0,            1, 0 },
+    { "",             10, 0,            0, 0 },    /* no digits */
+    { "-",            10, 0,            0, 0 },
+    { "z",            16, 0,            0, 0 },
+    { "123",           1, 0,            0, 0 },    /* unsupported bases */
+    { "123",          17, 0,            0, 0 }
+  };
+  uint32_t i;
+  int32_t value;
+  uint8_t overflow;
+  size_t consumed;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_atoi_parse()\n");
+
+  for (i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++)
+  {
+    overflow = 0xFF;
+    consumed = my_atoi_parse((const uint8_t *)cases[i].text, cases[i].base, &value, &overflow);
+    if ((consumed != cases[i].consumed) || (value != cases[i].value) ||
+        (overflow != cases[i].overflow))
+    {
+      TRACE("  my_atoi_parse(\"%s\", %u) failed\n", cases[i].text, cases[i].base);
+      ret = TEST_ERROR;
+    }
+  }
+
+  /* overflow may be NULL */
+  if (my_atoi_parse((const uint8_t *)"-42", 10, &value, NULL) != 3 || (value != -42))
+  {
+    ret = TEST_ERROR;
+  }
+  return ret;
+}
+
 int8_t test_memmove1() {
   uint8_t i;
   int8_t ret = TEST_NO_ERROR;
@@ -89,7 +230,7 @@ int8_t test_memmove1() {
   uint8_t * ptra;
   uint8_t * ptrb;
 
-  PRINTF("test_memmove1() - NO OVERLAP\n");
+  TRACE("test_memmove1() - NO OVERLAP\n");
   set = (uint8_t*) reserve_words( MEM_SET_SIZE_W );
 
   if (! set ) 
@@ -129,7 +270,7 @@ int8_t test_memmove2() {
   uint8_t * ptra;
   uint8_t * ptrb;
 
-  PRINTF("test_memmove2() -OVERLAP END OF SRC BEGINNING OF DST\n");
+  TRACE("test_memmove2() -OVERLAP END OF SRC BEGINNING OF DST\n");
   set = (uint8_t*) reserve_words(MEM_SET_SIZE_W);
 
   if (! set )
@@ -167,7 +308,7 @@ int8_t test_memmove3() {
   uint8_t * ptra;
   uint8_t * ptrb;
 
-  PRINTF("test_memove3() - OVERLAP END OF DEST BEGINNING OF SRC\n");
+  TRACE("test_memove3() - OVERLAP END OF DEST BEGINNING OF SRC\n");
   set = (uint8_t*)reserve_words( MEM_SET_SIZE_W);
 
   if (! set ) 
@@ -201,6 +342,53 @@ int8_t test_memmove3() {
 
 }
 
+int8_t test_memmove_clear() {
+  /* { src, dst } offsets in the set: disjoint both ways, dst above src, dst below src */
+  static const uint8_t cases[][2] = { { 0, 16 }, { 16, 0 }, { 4, 7 }, { 10, 7 } };
+  uint8_t set[MEM_SET_SIZE_B];
+  uint8_t expect[MEM_SET_SIZE_B];
+  uint8_t i, c, src, dst;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_memmove_clear()\n");
+
+  for (c = 0; c < (sizeof(cases) / sizeof(cases[0])); c++)
+  {
+    src = cases[c][0];
+    dst = cases[c][1];
+    for (i = 0; i < MEM_SET_SIZE_B; i++)
+    {
+      set[i] = i + 1;                                   /* no zero bytes before the move */
+    }
+    /* source bytes outside the destination become 0, the rest is unchanged */
+    for (i = 0; i < MEM_SET_SIZE_B; i++)
+    {
+      if ((i >= dst) && (i < (dst + TEST_MEMMOVE_LENGTH)))
+      {
+        expect[i] = set[src + (i - dst)];
+      }
+      else if ((i >= src) && (i < (src + TEST_MEMMOVE_LENGTH)))
+      {
+        expect[i] = 0;
+      }
+      else
+      {
+        expect[i] = set[i];
+      }
+    }
+
+    if (my_memmove_clear(&set[src], &set[dst], TEST_MEMMOVE_LENGTH) != &set[dst])
+    {
+      ret = TEST_ERROR;
+    }
+    for (i = 0; i < MEM_SET_SIZE_B; i++)
+    {
+      if (set[i] != expect[i]) ret = TEST_ERROR;
+    }
+  }
+  return ret;
+}
+
 int8_t test_memcopy() {
   uint8_t i;
   int8_t ret = TEST_NO_ERROR;
@@ -208,7 +396,7 @@ int8_t test_memcopy() {
   uint8_t * ptra;
   uint8_t * ptrb;
 
-  PRINTF("test_memcopy()\n");
+  TRACE("test_memcopy()\n");
   set = (uint8_t*) reserve_words(MEM_SET_SIZE_W);
 
   if (! set ) 
@@ -241,13 +429,17 @@ int8_t test_memcopy() {
 
 int8_t test_memset() 
 {
+  static const uint8_t pattern[16] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+                                       0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xF0, 0x0F };
   uint8_t i;
+  uint8_t width;
+  uint8_t offset;
   uint8_t ret = TEST_NO_ERROR;
   uint8_t * set;
   uint8_t * ptra;
   uint8_t * ptrb;
 
-  PRINTF("test_memset()\n");
+  TRACE("test_memset()\n");
   set = (uint8_t*)reserve_words(MEM_SET_SIZE_W);
   if (! set )
   {
@@ -280,7 +472,47 @@ int8_t test_memset()
       ret = TEST_ERROR;
     }
   }
-  
+
+  /* Pattern fill - 1, 2, 4 and 8 byte patterns from odd start addresses */
+  for (width = 1; width <= 8; width *= 2)
+  {
+    for (offset = 1; offset < 8; offset += 2)
+    {
+      my_memset(set, MEM_SET_SIZE_B, 0xEE);
+      if (my_memset_pattern(set + offset, PATTERN_FILL_LENGTH, pattern, width) != (set + offset))
+      {
+        ret = TEST_ERROR;
+      }
+      for (i = 0; i < MEM_SET_SIZE_B; i++)
+      {
+        uint8_t want = ((i >= offset) && (i < (offset + PATTERN_FILL_LENGTH))) ?
+                       pattern[(i - offset) % width] : 0xEE;
+        if (set[i] != want)
+        {
+          ret = TEST_ERROR;
+        }
+      }
+    }
+  }
+
+  /* Other pattern widths are refused and nothing is written */
+  my_memset(set, MEM_SET_SIZE_B, 0xEE);
+  for (width = 0; width <= 16; width++)
+  {
+    if ((width == 1) || (width == 2) || (width == 4) || (width == 8)) continue;
+    if (my_memset_pattern(set + 1, PATTERN_FILL_LENGTH, pattern, width) != NULL)
+    {
+      ret = TEST_ERROR;
+    }
+  }
+  for (i = 0; i < MEM_SET_SIZE_B; i++)
+  {
+    if (set[i] != 0xEE)
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
   free_words( (uint32_t*)set );
   return ret;
 }
@@ -296,7 +528,7 @@ int8_t test_reverse()
                                  0x20, 0x24, 0x7C, 0x20, 0x24, 0x69, 0x68, 0x54
                                };
 
-  PRINTF("test_reverse()\n");
+  TRACE("test_reverse()\n");
   copy = (uint8_t*)reserve_words(MEM_SET_SIZE_W);
   if (! copy )
   {
@@ -321,29 +553,1461 @@ int8_t test_reverse()
   return ret;
 }
 
-void course1(void) 
+int8_t test_arena()
 {
-  uint8_t i;
-  int8_t failed = 0;
-  int8_t results[TESTCOUNT];
+  static uint64_t buffer[ARENA_TEST_SIZE_D + 1];         /* + 1 - room to start misaligned */
+  static uint64_t storage[MEM_POOL_STORAGE_BYTES(ARENA_TEST_POOL_W, 1) / sizeof(uint64_t)];
+  mem_arena_t arena;
+  mem_arena_t heap_arena;
+  mem_arena_t * previous;
+  mem_pool_t pool;
+  int32_t * a;
+  int32_t * b;
+  int32_t * c;
+  size_t offset;
+  size_t rest;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_arena()\n");
+
+  if ((arena_init(NULL, (uint8_t *)buffer, 8) != NULL) || (arena_init(&arena, NULL, 8) != NULL))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* a misaligned buffer start is skipped, every block is aligned */
+  arena_init(&arena, (uint8_t *)buffer + 1, ARENA_TEST_SIZE_D * sizeof(uint64_t));
+  if ((arena.base != ((uint8_t *)buffer + MEM_ARENA_ALIGN)) ||
+      (arena.size != ((ARENA_TEST_SIZE_D * sizeof(uint64_t)) + 1 - MEM_ARENA_ALIGN)))
+  {
+    ret = TEST_ERROR;
+  }
+  a = arena_reserve_words(&arena, 1);
+  b = arena_reserve_words(&arena, 3);
+  if ((a == NULL) || (b == NULL) || (((uintptr_t)a & (MEM_ARENA_ALIGN - 1)) != 0) ||
+      (((uint8_t *)b - (uint8_t *)a) != MEM_ARENA_ALIGN))
+  {
+    return TEST_ERROR;
+  }
+
+  /* running out - the failed call takes nothing, the exact rest still fits */
+  offset = (arena.offset + (MEM_ARENA_ALIGN - 1)) & ~(size_t)(MEM_ARENA_ALIGN - 1);
+  rest = (arena.size - offset) / sizeof(int32_t);
+  offset = arena.offset;
+  if ((arena_reserve_words(&arena, rest + 1) != NULL) || (arena.offset != offset))
+  {
+    ret = TEST_ERROR;
+  }
+  c = arena_reserve_words(&arena, rest);
+  if ((c == NULL) || (((uintptr_t)c & (MEM_ARENA_ALIGN - 1)) != 0) ||
+      (arena_reserve_words(&arena, 1) != NULL))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* reset hands out the same memory again */
+  arena_reset(&arena);
+  if (arena_reserve_words(&arena, 1) != a)
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* arena on a malloc block */
+  if (arena_create(&heap_arena, ARENA_TEST_SIZE_D * sizeof(uint64_t)) != NULL)
+  {
+    a = arena_reserve_words(&heap_arena, (ARENA_TEST_SIZE_D * sizeof(uint64_t)) / sizeof(int32_t));
+    if ((a == NULL) || (((uintptr_t)a & (MEM_ARENA_ALIGN - 1)) != 0) ||
+        (arena_reserve_words(&heap_arena, 1) != NULL))
+    {
+      ret = TEST_ERROR;
+    }
+    arena_destroy(&heap_arena);
+    if ((heap_arena.base != NULL) || (heap_arena.heap != NULL))
+    {
+      ret = TEST_ERROR;
+    }
+  }
+
+  /* reserve_words tries the pools, then the arena, then malloc */
+  arena_reset(&arena);
+  previous = arena_install(&arena);
+  pool_init(&pool, (uint8_t *)storage, sizeof(storage), ARENA_TEST_POOL_W, 1);
+  pool_install(&pool, 1);
+  a = reserve_words(ARENA_TEST_POOL_W);                 /* pool block */
+  b = reserve_words(ARENA_TEST_POOL_W);                 /* pool empty - arena */
+  c = reserve_words(ARENA_TEST_POOL_W + 1);             /* too big for the pool - arena */
+  if (!pool_owns(&pool, a) ||
+      ((uint8_t *)b < arena.base) || ((uint8_t *)b >= (arena.base + arena.size)) ||
+      ((uint8_t *)c < arena.base) || ((uint8_t *)c >= (arena.base + arena.size)))
+  {
+    ret = TEST_ERROR;
+  }
+  free_words((uint32_t *)c);                            /* arena blocks are left alone */
+  free_words((uint32_t *)b);
+  free_words((uint32_t *)a);
+  if ((pool.in_use != 0) || (arena.offset == 0))
+  {
+    ret = TEST_ERROR;
+  }
+  pool_install(NULL, 0);
+  arena_install(NULL);
+  c = reserve_words(ARENA_TEST_POOL_W);                 /* nothing installed - heap */
+  if ((c != NULL) && (pool_owns(&pool, c) ||
+      (((uint8_t *)c >= arena.base) && ((uint8_t *)c < (arena.base + arena.size)))))
+  {
+    ret = TEST_ERROR;
+  }
+  free_words((uint32_t *)c);
+
+  /* free after uninstall - blocks still go back to their pool / arena, not to free() */
+  pool_init(&pool, (uint8_t *)storage, sizeof(storage), ARENA_TEST_POOL_W, 1);
+  arena_reset(&arena);
+  arena_install(&arena);
+  pool_install(&pool, 1);
+  a = reserve_words(ARENA_TEST_POOL_W);                 /* pool block */
+  b = reserve_words(ARENA_TEST_POOL_W);                 /* arena block */
+  pool_install(NULL, 0);
+  arena_install(NULL);
+  free_words((uint32_t *)b);
+  free_words((uint32_t *)a);
+  if ((a == NULL) || (b == NULL) || (pool.in_use != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* a retired arena installed again takes its live blocks back */
+  arena_install(&arena);
+  b = reserve_words(1);
+  arena_install(NULL);
+  arena_install(&arena);
+  arena_install(NULL);
+  free_words((uint32_t *)b);
+  arena_install(previous);
+
+  return ret;
+}
+
+int8_t test_pool()
+{
+  static uint64_t small_storage[MEM_POOL_STORAGE_BYTES(POOL_TEST_SMALL_W, POOL_TEST_BLOCKS) /
+                                sizeof(uint64_t)];
+  static uint64_t large_storage[MEM_POOL_STORAGE_BYTES(POOL_TEST_LARGE_W, POOL_TEST_BLOCKS) /
+                                sizeof(uint64_t)];
+  static uint64_t buffer[ARENA_TEST_SIZE_D];
+  mem_pool_t pools[2];
+  mem_pool_t * small = &pools[0];
+  mem_pool_t * large = &pools[1];
+  mem_arena_t arena;
+  mem_arena_t * previous;
+  int32_t * blocks[POOL_TEST_BLOCKS];
+  int32_t * a;
+  int32_t * b;
+  int32_t * c;
+  int32_t * d;
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_pool()\n");
+
+  /* storage missing, unaligned or too small */
+  if ((pool_init(small, NULL, sizeof(small_storage), POOL_TEST_SMALL_W, 1) != NULL) ||
+      (pool_init(small, (uint8_t *)small_storage + 4, sizeof(small_storage) - 4,
+                 POOL_TEST_SMALL_W, 1) != NULL) ||
+      (pool_init(small, (uint8_t *)small_storage, sizeof(small_storage),
+                 POOL_TEST_SMALL_W, POOL_TEST_BLOCKS + 1) != NULL))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* every block once, then empty; the high water mark stays at the peak */
+  pool_init(small, (uint8_t *)small_storage, sizeof(small_storage), POOL_TEST_SMALL_W,
+            POOL_TEST_BLOCKS);
+  for (i = 0; i < POOL_TEST_BLOCKS; i++)
+  {
+    blocks[i] = pool_reserve(small);
+    if ((blocks[i] == NULL) || !pool_owns(small, blocks[i]) ||
+        (((uintptr_t)blocks[i] & (MEM_ARENA_ALIGN - 1)) != 0) ||
+        ((i > 0) && (blocks[i] == blocks[i - 1])))
+    {
+      return TEST_ERROR;
+    }
+  }
+  if ((pool_reserve(small) != NULL) || (small->in_use != POOL_TEST_BLOCKS) ||
+      (small->high_water != POOL_TEST_BLOCKS))
+  {
+    ret = TEST_ERROR;
+  }
+  if (!pool_release(small, blocks[0]) || !pool_release(small, blocks[1]) ||
+      (small->in_use != (POOL_TEST_BLOCKS - 2)) || (small->high_water != POOL_TEST_BLOCKS) ||
+      (pool_reserve(small) != blocks[1]))                 /* last released first */
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* double free, pointer inside a block, foreign pointer - refused */
+  if (pool_release(small, blocks[0]) || pool_release(small, (uint8_t *)blocks[2] + 4) ||
+      pool_release(small, buffer) || (small->in_use != (POOL_TEST_BLOCKS - 1)))
+  {
+    ret = TEST_ERROR;
+  }
+  for (i = 1; i < POOL_TEST_BLOCKS; i++)
+  {
+    pool_release(small, blocks[i]);
+  }
+  if ((small->in_use != 0) || pool_release(small, blocks[1]))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* size classes: a full class falls through to the next, then to the arena */
+  pool_init(small, (uint8_t *)small_storage, sizeof(small_storage), POOL_TEST_SMALL_W,
+            POOL_TEST_BLOCKS);
+  pool_init(large, (uint8_t *)large_storage, sizeof(large_storage), POOL_TEST_LARGE_W, 1);
+  arena_init(&arena, (uint8_t *)buffer, sizeof(buffer));
+  previous = arena_install(&arena);
+  pool_install(pools, 2);
+  for (i = 0; i < POOL_TEST_BLOCKS; i++)
+  {
+    blocks[i] = reserve_words(POOL_TEST_SMALL_W);
+  }
+  a = reserve_words(POOL_TEST_SMALL_W);                  /* small class full - large */
+  b = reserve_words(POOL_TEST_SMALL_W);                  /* both full - arena */
+  c = reserve_words(POOL_TEST_LARGE_W + 1);              /* too big for any class - arena */
+  if (!pool_owns(small, blocks[POOL_TEST_BLOCKS - 1]) || !pool_owns(large, a) ||
+      (b == NULL) || (c == NULL) || pool_owns(small, b) || pool_owns(large, b) ||
+      (small->high_water != POOL_TEST_BLOCKS) || (large->high_water != 1))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* free_words gives each block back to its own pool */
+  free_words((uint32_t *)a);
+  free_words((uint32_t *)blocks[0]);
+  if ((large->in_use != 0) || (small->in_use != (POOL_TEST_BLOCKS - 1)))
+  {
+    ret = TEST_ERROR;
+  }
+  d = reserve_words(POOL_TEST_LARGE_W);
+  if (d != a)
+  {
+    ret = TEST_ERROR;
+  }
+  free_words((uint32_t *)d);
+  for (i = 1; i < POOL_TEST_BLOCKS; i++)
+  {
+    free_words((uint32_t *)blocks[i]);
+  }
+  free_words((uint32_t *)b);
+  free_words((uint32_t *)c);
+  if ((small->in_use != 0) || (large->in_use != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  pool_install(NULL, 0);
+  arena_install(previous);
+  return ret;
+}
+
+/* Deterministic pseudo random numbers for test_median (LCG) */
+static uint32_t test_random(uint32_t * state)
+{
+  *state = (*state * 1664525u) + 1013904223u;
+  return *state >> 8;
+}
+
+int8_t test_sort_array()
+{
+  static uint8_t set[SORT_SET_SIZE];
+  static const uint32_t lengths[] = { 1, STATS_SMALL_SORT_LENGTH, STATS_SMALL_SORT_LENGTH + 1,
+                                      SORT_SET_SIZE };
+  uint32_t counts[STATS_BUCKETS];
+  uint32_t state = 0x50A7u;
+  uint32_t l, i, length;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_sort_array()\n");
+
+  for (l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+  {
+    length = lengths[l];
+    for (i = 0; i < STATS_BUCKETS; i++)
+    {
+      counts[i] = 0;
+    }
+    /* few distinct values - many duplicates - and both ends of the range */
+    for (i = 0; i < length; i++)
+    {
+      set[i] = (uint8_t)((test_random(&state) % 12) * 23);
+      if (i == (length / 2)) set[i] = 255;
+      if (i == (length / 3)) set[i] = 0;
+      counts[set[i]]++;
+    }
+
+    sort_array(set, length);
+
+    /* largest first, same items */
+    for (i = 0; i < length; i++)
+    {
+      if ((i > 0) && (set[i] > set[i - 1])) ret = TEST_ERROR;
+      counts[set[i]]--;
+    }
+    for (i = 0; i < STATS_BUCKETS; i++)
+    {
+      if (counts[i] != 0) ret = TEST_ERROR;
+    }
+  }
+  return ret;
+}
+
+/* McIlroy's adversary for the median of three quickselect of stats_select:
+ * the partition loop is replayed on element ids while values are fixed only
+ * when a comparison needs them, always making the pivot a small item. With
+ * the fixed values the real select keeps cutting off a few items per round
+ * until it runs out of depth and takes its heap sort fallback. The values are
+ * 0 .. length - 1 in some order. */
+static int32_t * killer_value;        /* value of each id, length while not fixed */
+static int32_t killer_fixed;          /* next value to fix */
+static uint16_t killer_candidate;     /* last unfixed id compared - pivot candidate */
+static uint32_t killer_length;
+
+static int32_t killer_compare(uint16_t x, uint16_t y)
+{
+  int32_t gas = (int32_t)killer_length;
+
+  if ((killer_value[x] == gas) && (killer_value[y] == gas))
+  {
+    killer_value[(x == killer_candidate) ? x : y] = killer_fixed++;
+  }
+  if (killer_value[x] == gas)
+  {
+    killer_candidate = x;
+  }
+  else if (killer_value[y] == gas)
+  {
+    killer_candidate = y;
+  }
+  return killer_value[x] - killer_value[y];
+}
+
+static void killer_swap(uint16_t * a, uint16_t * b)
+{
+  uint16_t id = *a;
+  *a = *b;
+  *b = id;
+}
+
+static void median_killer(int32_t * values, uint16_t * ids, uint32_t length)
+{
+  uint32_t lo = 0, hi = length, rank = (length - 1) / 2;
+  uint32_t mid, i, j, n;
+  uint32_t depth = 0;
+  uint16_t pivot;
+
+  killer_value = values;
+  killer_fixed = 0;
+  killer_candidate = 0;
+  killer_length = length;
+  for (i = 0; i < length; i++)
+  {
+    values[i] = (int32_t)length;
+    ids[i] = (uint16_t)i;
+  }
+  for (n = length; n > 1; n >>= 1) depth += 2;
+
+  while (((hi - lo) > STATS_SMALL_SORT_LENGTH) && (depth-- != 0))
+  {
+    mid = lo + ((hi - lo) / 2);
+    if (killer_compare(ids[mid], ids[lo]) < 0) killer_swap(&ids[mid], &ids[lo]);
+    if (killer_compare(ids[hi - 1], ids[lo]) < 0) killer_swap(&ids[hi - 1], &ids[lo]);
+    if (killer_compare(ids[hi - 1], ids[mid]) < 0) killer_swap(&ids[hi - 1], &ids[mid]);
+    pivot = ids[mid];
+    i = lo;
+    j = hi - 1;
+    for (;;)
+    {
+      while (killer_compare(ids[i], pivot) < 0) i++;
+      while (killer_compare(ids[j], pivot) > 0) j--;
+      if (i >= j) break;
+      killer_swap(&ids[i], &ids[j]);
+      i++;
+      j--;
+    }
+    if (rank <= j) hi = j + 1;
+    else lo = j + 1;
+  }
+
+  for (i = 0; i < length; i++)                    /* the rest - largest values */
+  {
+    if (values[i] == (int32_t)length) values[i] = killer_fixed++;
+  }
+}
+
+int8_t test_median()
+{
+  uint32_t state = 0x2017u;
+  uint32_t round;
+  uint32_t length;
+  uint32_t i;
+  uint32_t j;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t set8[MEDIAN_SET_SIZE_MAX];
+  uint8_t sorted8[MEDIAN_SET_SIZE_MAX];
+  int32_t set32[MEDIAN_SET_SIZE_MAX];
+  int32_t sorted32[MEDIAN_SET_SIZE_MAX];
+  uint8_t expect8;
+  int32_t expect32;
+  int32_t median32;
+  uint8_t copy8[MEDIAN_SET_SIZE_MAX];
+  int32_t copy32[MEDIAN_SET_SIZE_MAX];
+  uint64_t scratch[(MEDIAN_SET_SIZE_MAX + 1) / 2];  /* 8 byte aligned - no arena padding */
+  static int32_t shape[MEDIAN_SHAPE_SIZE_MAX];
+  static uint16_t shape_ids[MEDIAN_SHAPE_SIZE_MAX];
+  static const uint32_t shape_lengths[] = { STATS_SMALL_SORT_LENGTH + 1, 100, 255, 256,
+                                            MEDIAN_SHAPE_SIZE_MAX - 1, MEDIAN_SHAPE_SIZE_MAX };
+  uint32_t l, form;
+  mem_arena_t arena;
+  mem_arena_t * previous;
+
+  TRACE("test_median()\n");
+
+  /* find_median_i32 copies into reserve_words - reset this arena each round */
+  arena_init(&arena, (uint8_t *)scratch, sizeof(scratch));
+  previous = arena_install(&arena);
+
+  for (round = 0; round < MEDIAN_ROUNDS; round++)
+  {
+    length = 1 + (test_random(&state) % MEDIAN_SET_SIZE_MAX);
+
+    /* Every other round uses a narrow range so duplicates are common */
+    for (i = 0; i < length; i++)
+    {
+      set8[i] = (uint8_t)test_random(&state);
+      set32[i] = (int32_t)(test_random(&state) << 8) ^ (int32_t)test_random(&state);
+      if (round & 1)
+      {
+        set8[i] &= 0x07;
+        set32[i] = (int32_t)(set32[i] % 5);
+      }
+      copy8[i] = set8[i];
+      copy32[i] = set32[i];
+    }
+
+    /* Reference: insertion sort of a copy */
+    for (i = 0; i < length; i++)
+    {
+      for (j = i; (j > 0) && (sorted8[j - 1] > set8[i]); j--)
+      {
+        sorted8[j] = sorted8[j - 1];
+      }
+      sorted8[j] = set8[i];
+      for (j = i; (j > 0) && (sorted32[j - 1] > set32[i]); j--)
+      {
+        sorted32[j] = sorted32[j - 1];
+      }
+      sorted32[j] = set32[i];
+    }
+
+    expect8 = sorted8[(length - 1) / 2];
+    expect32 = sorted32[(length - 1) / 2];
+    if ((length % 2) == 0)
+    {
+      expect8 = (uint8_t)(((uint32_t)expect8 + sorted8[length / 2]) / 2);
+      expect32 = (int32_t)(((int64_t)expect32 + sorted32[length / 2]) / 2);
+    }
+
+    if (find_median(set8, length) != expect8)
+    {
+      ret = TEST_ERROR;
+    }
+    if (!find_median_i32(set32, length, 0, &median32) || (median32 != expect32))
+    {
+      ret = TEST_ERROR;
+    }
+
+    /* The data sets must still be in their original order */
+    for (i = 0; i < length; i++)
+    {
+      if ((set8[i] != copy8[i]) || (set32[i] != copy32[i]))
+      {
+        ret = TEST_ERROR;
+      }
+    }
+
+    if (!find_median_i32(set32, length, 1, &median32) || (median32 != expect32))
+    {
+      ret = TEST_ERROR;
+    }
+    arena_reset(&arena);
+  }
+
+  /* Empty set: median 0 and no error. Arena too small for the copy: an error,
+   * not a median of 0, and the data set is left alone; in place needs no copy. */
+  set32[0] = 3;
+  set32[1] = 9;
+  set32[2] = 6;
+  arena_init(&arena, (uint8_t *)scratch, 2 * sizeof(int32_t));
+  if (!find_median_i32(set32, 0, 0, &median32) || (median32 != 0) ||
+      find_median_i32(set32, 3, 0, &median32) || (median32 != 0) ||
+      (set32[0] != 3) || (set32[1] != 9) || (set32[2] != 6) ||
+      !find_median_i32(set32, 3, 1, &median32) || (median32 != 6))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* Large sets in shapes which are hard on quickselect pivots:
+   * sorted, reversed, all equal, organ pipe (0 1 2 .. 2 1 0) and
+   * a median of three killer (heap sort fallback).
+   * Sorted, each shape holds k / 2 or k at rank k (or only 7). */
+  for (l = 0; l < (sizeof(shape_lengths) / sizeof(shape_lengths[0])); l++)
+  {
+    length = shape_lengths[l];
+    for (form = 0; form < 5; form++)
+    {
+      for (i = 0; (form < 4) && (i < length); i++)
+      {
+        switch (form)
+        {
+          case 0:  shape[i] = (int32_t)i; break;
+          case 1:  shape[i] = (int32_t)(length - 1 - i); break;
+          case 2:  shape[i] = 7; break;
+          default: shape[i] = (int32_t)((i < (length - 1 - i)) ? i : (length - 1 - i)); break;
+        }
+      }
+      if (form == 4)
+      {
+        median_killer(shape, shape_ids, length);
+      }
+      if (form == 2)
+      {
+        expect32 = 7;
+      }
+      else if (form == 3)
+      {
+        expect32 = (int32_t)((((length - 1) / 2) / 2 + (length / 2) / 2) / 2);
+      }
+      else
+      {
+        expect32 = (int32_t)(((length - 1) / 2 + length / 2) / 2);
+      }
+      if (!find_median_i32(shape, length, 1, &median32) || (median32 != expect32))
+      {
+        ret = TEST_ERROR;
+      }
+    }
+  }
+
+  arena_install(previous);
+  return ret;
+}
+
+int8_t test_rank_percentile()
+{
+  /* sorted: 5 5 5 10 200 200 200 200 255 255 - stored shuffled */
+  static const uint8_t set[10] = { 200, 5, 255, 10, 200, 5, 200, 255, 5, 200 };
+  static const uint8_t ranks[10] = { 5, 5, 5, 10, 200, 200, 200, 200, 255, 255 };
+  static const uint8_t percents[][2] = {
+    { 0, 5 }, { 10, 5 }, { 30, 5 }, { 31, 10 }, { 40, 10 }, { 41, 200 },
+    { 50, 200 }, { 80, 200 }, { 81, 255 }, { 100, 255 }, { 101, 255 }
+  };
+  static const uint8_t single = 42;
+  static stats_result_t result;
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_rank_percentile()\n");
+
+  compute_statistics(set, sizeof(set), &result);
+  for (i = 0; i < sizeof(set); i++)
+  {
+    if (stats_value_at_rank(&result, i) != ranks[i]) ret = TEST_ERROR;
+  }
+  if ((stats_value_at_rank(&result, sizeof(set)) != 255) ||      /* past the end - maximum */
+      (stats_value_at_rank(&result, 0xFFFFFFFFUL) != 255))
+  {
+    ret = TEST_ERROR;
+  }
+  for (i = 0; i < (sizeof(percents) / sizeof(percents[0])); i++)
+  {
+    if (stats_percentile(&result, percents[i][0]) != percents[i][1]) ret = TEST_ERROR;
+  }
+
+  /* one item - every rank and percentile is that item */
+  compute_statistics(&single, 1, &result);
+  if ((stats_value_at_rank(&result, 0) != single) || (stats_percentile(&result, 0) != single) ||
+      (stats_percentile(&result, 100) != single))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* no items */
+  compute_statistics(set, 0, &result);
+  if ((stats_percentile(&result, 0) != 0) || (stats_percentile(&result, 100) != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* find_median - mean of the two middle items, odd count, 255 in the middle */
+  if ((find_median((uint8_t *)set, sizeof(set)) != 200) ||
+      (find_median((uint8_t *)set, 3) != 200) ||                 /* 5 200 255 */
+      (find_median((uint8_t *)set, 4) != 105) ||                 /* 5 10 200 255 */
+      (find_median((uint8_t *)&set[2], 1) != 255) ||
+      (find_median((uint8_t *)set, 0) != 0))
+  {
+    ret = TEST_ERROR;
+  }
+  return ret;
+}
+
+/* Compare two statistics results, variance to a relative 1e-9 */
+static int8_t test_same_statistics(const stats_result_t * a, const stats_result_t * b)
+{
+  uint32_t i;
+  double diff = a->variance - b->variance;
+
+  if ((a->count != b->count) || (a->sum != b->sum) ||
+      (a->minimum != b->minimum) || (a->maximum != b->maximum) ||
+      (a->mean != b->mean) || (a->median != b->median))
+  {
+    return TEST_ERROR;
+  }
+  if (diff < 0)
+  {
+    diff = -diff;
+  }
+  if (diff > (1e-9 * (b->variance + 1.0)))
+  {
+    return TEST_ERROR;
+  }
+  for (i = 0; i < STATS_BUCKETS; i++)
+  {
+    if (a->histogram[i] != b->histogram[i])
+    {
+      return TEST_ERROR;
+    }
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_stats_stream()
+{
+  /* static - accumulators and results are too large for a small stack */
+  static uint8_t set[STREAM_SET_SIZE];
+  static stats_acc_t first;            /* all items first, then the first part */
+  static stats_acc_t second;
+  static stats_result_t expect;
+  static stats_result_t actual;
+  uint32_t state = 0xC0FFEEu;
+  uint32_t split = STREAM_SET_SIZE / 3;
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_stats_stream()\n");
+
+  /* Skewed data - a mean far from zero shows variance cancellation errors */
+  for (i = 0; i < STREAM_SET_SIZE; i++)
+  {
+    set[i] = (uint8_t)(200 + (test_random(&state) % 56));
+  }
+  compute_statistics(set, STREAM_SET_SIZE, &expect);
+
+  /* Empty accumulator reports zeros */
+  stats_init(&first);
+  stats_snapshot(&first, &actual);
+  if ((actual.count != 0) || (actual.minimum != 0) || (actual.maximum != 0))
+  {
+    ret = TEST_ERROR;
+  }
+
+  for (i = 0; i < STREAM_SET_SIZE; i++)
+  {
+    stats_push(&first, set[i]);
+  }
+  stats_snapshot(&first, &actual);
+  ret |= test_same_statistics(&actual, &expect);
+
+  stats_init(&first);                  /* reuse - one accumulator less of RAM */
+  stats_init(&second);
+  stats_push_block(&first, set, split);
+  stats_push_block(&second, &set[split], STREAM_SET_SIZE - split);
+  stats_merge(&first, &second);
+  stats_snapshot(&first, &actual);
+  ret |= test_same_statistics(&actual, &expect);
+
+  return ret;
+}
+
+int8_t test_stats_parallel()
+{
+  static uint8_t set[PARALLEL_SET_SIZE];
+  static stats_result_t expect;
+  static stats_result_t actual;
+  uint32_t state = 0xBADCAFEu;
+  uint32_t threads;
+  uint32_t i;
+  task_pool_t * pool;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_stats_parallel()\n");
+
+  for (i = 0; i < PARALLEL_SET_SIZE; i++)
+  {
+    set[i] = (uint8_t)test_random(&state);
+  }
+  compute_statistics(set, PARALLEL_SET_SIZE, &expect);
+
+  compute_statistics_parallel(set, PARALLEL_SET_SIZE, &actual, NULL);
+  ret |= test_same_statistics(&actual, &expect);
+
+  /* Odd thread counts leave partials without a merge partner in some rounds;
+   * each pool is used twice - its threads serve every call */
+  for (threads = 1; threads <= PARALLEL_MAX_THREADS; threads++)
+  {
+    pool = task_pool_create(threads);
+    for (i = 0; i < 2; i++)
+    {
+      compute_statistics_parallel(set, PARALLEL_SET_SIZE, &actual, pool);
+      ret |= test_same_statistics(&actual, &expect);
+    }
+    task_pool_destroy(pool);
+  }
+
+  /* A short set stays single threaded: merged partials round the variance
+   * differently, compute_statistics gives it to the last bit */
+  compute_statistics(set, STREAM_SET_SIZE, &expect);
+  pool = task_pool_create(PSORT_THREADS);
+  compute_statistics_parallel(set, STREAM_SET_SIZE, &actual, pool);
+  task_pool_destroy(pool);
+  ret |= test_same_statistics(&actual, &expect);
+  if (actual.variance != expect.variance)
+  {
+    ret = TEST_ERROR;
+  }
+
+  return ret;
+}
+
+/* Check stats_compute_* results against the same values held as doubles */
+static int8_t test_generic_check(const double * values, uint32_t length,
+                                 const stats_generic_result_t * result)
+{
+  double sorted[MEDIAN_SET_SIZE_MAX];
+  double sum = 0.0;
+  double m2 = 0.0;
+  double mean;
+  double diff;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < length; i++)
+  {
+    for (j = i; (j > 0) && (sorted[j - 1] > values[i]); j--)
+    {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = values[i];
+    sum += values[i];
+  }
+  mean = sum / length;
+  for (i = 0; i < length; i++)
+  {
+    m2 += (values[i] - mean) * (values[i] - mean);
+  }
+
+  if ((result->count != length) || (result->minimum != sorted[0]) ||
+      (result->maximum != sorted[length - 1]) ||
+      (result->median != ((sorted[(length - 1) / 2] + sorted[length / 2]) / 2.0)))
+  {
+    return TEST_ERROR;
+  }
+  /* mean and variance to a relative 1e-9 */
+  diff = (result->mean - mean) / (((mean < 0.0) ? -mean : mean) + 1.0);
+  if ((diff > 1e-9) || (diff < -1e-9))
+  {
+    return TEST_ERROR;
+  }
+  diff = (result->variance - (m2 / length)) / ((m2 / length) + 1.0);
+  if ((diff > 1e-9) || (diff < -1e-9))
+  {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_stats_generic()
+{
+  uint32_t state = 0x5EED5u;
+  uint32_t round;
+  uint32_t length;
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+  double values[MEDIAN_SET_SIZE_MAX];
+  uint8_t set_u8[MEDIAN_SET_SIZE_MAX];
+  int16_t set_i16[MEDIAN_SET_SIZE_MAX];
+  uint16_t set_u16[MEDIAN_SET_SIZE_MAX];
+  int32_t set_i32[MEDIAN_SET_SIZE_MAX];
+  float set_f32[MEDIAN_SET_SIZE_MAX];
+  double set_f64[MEDIAN_SET_SIZE_MAX];
+  stats_generic_result_t result;
+  uint32_t scratch[4 * MEDIAN_SET_SIZE_MAX];         /* i32 + f32 + f64 copies */
+  mem_arena_t arena;
+  mem_arena_t * previous;
+
+  TRACE("test_stats_generic()\n");
+
+  /* the wide types copy the data set into reserve_words for the median */
+  arena_init(&arena, (uint8_t *)scratch, sizeof(scratch));
+  previous = arena_install(&arena);
+
+  for (round = 0; round < MEDIAN_ROUNDS; round++)
+  {
+    length = 1 + (test_random(&state) % MEDIAN_SET_SIZE_MAX);
+
+    for (i = 0; i < length; i++)
+    {
+      set_u8[i] = (uint8_t)test_random(&state);
+      values[i] = set_u8[i];
+    }
+    ret |= (stats_compute_u8(set_u8, length, &result) == 1) ? 0 : TEST_ERROR;
+    ret |= test_generic_check(values, length, &result);
+
+    for (i = 0; i < length; i++)
+    {
+      set_i16[i] = (int16_t)test_random(&state);
+      values[i] = set_i16[i];
+    }
+    ret |= (stats_compute_i16(set_i16, length, &result) == 1) ? 0 : TEST_ERROR;
+    ret |= test_generic_check(values, length, &result);
+
+    for (i = 0; i < length; i++)
+    {
+      set_u16[i] = (uint16_t)test_random(&state);
+      values[i] = set_u16[i];
+    }
+    ret |= (stats_compute_u16(set_u16, length, &result) == 1) ? 0 : TEST_ERROR;
+    ret |= test_generic_check(values, length, &result);
+
+    for (i = 0; i < length; i++)
+    {
+      set_i32[i] = (int32_t)(test_random(&state) << 8) ^ (int32_t)test_random(&state);
+      values[i] = set_i32[i];
+    }
+    ret |= (stats_compute_i32(set_i32, length, &result) == 1) ? 0 : TEST_ERROR;
+    ret |= test_generic_check(values, length, &result);
+
+    for (i = 0; i < length; i++)
+    {
+      set_f32[i] = (float)((int32_t)test_random(&state) - 0x800000) / 64.0f;
+      values[i] = set_f32[i];
+    }
+    ret |= (stats_compute_f32(set_f32, length, &result) == 1) ? 0 : TEST_ERROR;
+    ret |= test_generic_check(values, length, &result);
+
+    for (i = 0; i < length; i++)
+    {
+      set_f64[i] = (double)test_random(&state) / 1024.0;
+      values[i] = set_f64[i];
+    }
+    ret |= (stats_compute_f64(set_f64, length, &result) == 1) ? 0 : TEST_ERROR;
+    ret |= test_generic_check(values, length, &result);
+
+    arena_reset(&arena);
+  }
+
+  arena_install(previous);
+  return ret;
+}
+
+/*
+ * One item type of test_stats_select: fill set with GEN (random bits in r),
+ * select a random rank and check it against the reference insertion sort of a
+ * copy, with no larger item before and no smaller item after it.
+ */
+#define TEST_SELECT_CASE(T, SFX, GEN)                                     \
+  {                                                                       \
+    T set[MEDIAN_SET_SIZE_MAX];                                           \
+    T sorted[MEDIAN_SET_SIZE_MAX];                                        \
+    uint32_t rank;                                                        \
+                                                                          \
+    for (i = 0; i < length; i++)                                          \
+    {                                                                     \
+      uint32_t r = test_random(&state);                                   \
+      set[i] = (GEN);                                                     \
+      for (j = i; (j > 0) && (sorted[j - 1] > set[i]); j--)               \
+      {                                                                   \
+        sorted[j] = sorted[j - 1];                                        \
+      }                                                                   \
+      sorted[j] = set[i];                                                 \
+    }                                                                     \
+    rank = test_random(&state) % length;                                  \
+    stats_select_##SFX(set, length, rank);                                \
+    if (set[rank] != sorted[rank])                                        \
+    {                                                                     \
+      ret = TEST_ERROR;                                                   \
+    }                                                                     \
+    for (i = 0; i < length; i++)                                          \
+    {                                                                     \
+      if (((i < rank) && (set[i] > set[rank])) ||                         \
+          ((i > rank) && (set[i] < set[rank])))                           \
+      {                                                                   \
+        ret = TEST_ERROR;                                                 \
+      }                                                                   \
+    }                                                                     \
+  }
+
+int8_t test_stats_select()
+{
+  uint32_t state = 0x5E1EC7u;
+  uint32_t round;
+  uint32_t length;
+  uint32_t i;
+  uint32_t j;
+  int8_t ret = TEST_NO_ERROR;
+  float zeros[4] = { -0.0f, 0.0f, -0.0f, 0.0f };
+
+  TRACE("test_stats_select()\n");
+
+  for (round = 0; round < MEDIAN_ROUNDS; round++)
+  {
+    length = 1 + (test_random(&state) % MEDIAN_SET_SIZE_MAX);
+
+    /* Unsigned items with the top bit set, few and many duplicates */
+    TEST_SELECT_CASE(uint8_t,  u8,  (uint8_t)(r << ((round & 1) ? 6 : 0)))
+    TEST_SELECT_CASE(uint16_t, u16, (uint16_t)(r << ((round & 1) ? 14 : 4)))
+    /* Signed zeros mixed with -1 and 1: -0.0 and +0.0 must compare equal */
+    TEST_SELECT_CASE(float,    f32, ((r & 3) == 0) ? -0.0f : ((r & 3) == 1) ? 0.0f :
+                                    (float)((int32_t)((r >> 2) % 3) - 1))
+    TEST_SELECT_CASE(double,   f64, ((r & 3) == 0) ? -0.0 : ((r & 3) == 1) ? 0.0 :
+                                    (double)((int32_t)(r >> 2) - 0x200000) * 1e-3)
+  }
+
+  /* only zeros - the middle is a zero of either sign */
+  stats_select_f32(zeros, 4, 1);
+  if ((zeros[1] != 0.0f) || (zeros[0] != 0.0f) || (zeros[2] != 0.0f) || (zeros[3] != 0.0f))
+  {
+    ret = TEST_ERROR;
+  }
+
+  return ret;
+}
+
+/*
+ * One key type of test_radix_sort: fill set with GEN (random bits in r), sort
+ * it both ways and compare against the reference insertion sort of a copy.
+ */
+#define TEST_RADIX_CASE(T, SFX, GEN)                                      \
+  {                                                                       \
+    T set[MEDIAN_SET_SIZE_MAX];                                           \
+    T scratch[MEDIAN_SET_SIZE_MAX];                                       \
+    T sorted[MEDIAN_SET_SIZE_MAX];                                        \
+    uint8_t descending;                                                   \
+                                                                          \
+    for (i = 0; i < length; i++)                                          \
+    {                                                                     \
+      uint32_t r = test_random(&state);                                   \
+      set[i] = (GEN);                                                     \
+      for (j = i; (j > 0) && (sorted[j - 1] > set[i]); j--)               \
+      {                                                                   \
+        sorted[j] = sorted[j - 1];                                        \
+      }                                                                   \
+      sorted[j] = set[i];                                                 \
+    }                                                                     \
+    for (descending = 0; descending < 2; descending++)                    \
+    {                                                                     \
+      stats_sort_##SFX(set, scratch, length, descending);                 \
+      for (i = 0; i < length; i++)                                        \
+      {                                                                   \
+        if (set[i] != sorted[descending ? (length - 1 - i) : i])          \
+        {                                                                 \
+          ret = TEST_ERROR;                                               \
+        }                                                                 \
+      }                                                                   \
+    }                                                                     \
+  }
+
+int8_t test_radix_sort()
+{
+  uint32_t state = 0x7AD1Cu;
+  uint32_t round;
+  uint32_t length;
+  uint32_t i;
+  uint32_t j;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_radix_sort()\n");
+
+  for (round = 0; round < MEDIAN_ROUNDS; round++)
+  {
+    length = 1 + (test_random(&state) % MEDIAN_SET_SIZE_MAX);
+
+    /* Items with and without the sign bit, few and many duplicates */
+    TEST_RADIX_CASE(uint16_t, u16, (uint16_t)(r << ((round & 1) ? 12 : 0)))
+    TEST_RADIX_CASE(int16_t,  i16, (int16_t)r)
+    TEST_RADIX_CASE(uint32_t, u32, r << 8)
+    TEST_RADIX_CASE(int32_t,  i32, (int32_t)(r << 8) / ((round & 1) ? 1 : 0x10000))
+    TEST_RADIX_CASE(uint64_t, u64, ((uint64_t)r << 40) | r)
+    TEST_RADIX_CASE(int64_t,  i64, (int64_t)(((uint64_t)r << 40) | r))
+    TEST_RADIX_CASE(float,    f32, (float)((int32_t)r - 0x800000) / 256.0f)
+    TEST_RADIX_CASE(double,   f64, (double)((int32_t)r - 0x800000) * 1e-3)
+  }
+
+  return ret;
+}
+
+int8_t test_parallel_sort()
+{
+  static int32_t set[PSORT_SET_SIZE];
+  static int32_t expect[PSORT_SET_SIZE];
+  static int32_t scratch[PSORT_SET_SIZE];
+  uint32_t state = 0x50127u;
+  uint32_t i;
+  uint8_t descending;
+  int8_t ret = TEST_NO_ERROR;
+  task_pool_t * pool;
+
+  TRACE("test_parallel_sort()\n");
+
+  /* NULL without threads - sort_parallel_i32 then runs single threaded */
+  pool = task_pool_create(PSORT_THREADS);
+
+  for (descending = 0; descending < 2; descending++)
+  {
+    for (i = 0; i < PSORT_SET_SIZE; i++)
+    {
+      set[i] = (int32_t)(test_random(&state) << 8) ^ (int32_t)test_random(&state);
+      expect[i] = set[i];
+    }
+    stats_sort_i32(expect, scratch, PSORT_SET_SIZE, descending);
+    sort_parallel_i32(set, scratch, PSORT_SET_SIZE, descending, pool);
+
+    for (i = 0; i < PSORT_SET_SIZE; i++)
+    {
+      if (set[i] != expect[i])
+      {
+        ret = TEST_ERROR;
+      }
+    }
+  }
+
+  task_pool_destroy(pool);
+  return ret;
+}
+
+static uint32_t dispatch_binds;                 /* calls of dispatch_bind */
+
+static void dispatch_bind(cpu_isa_t isa)
+{
+  (void)isa;
+  dispatch_binds++;
+}
+
+int8_t test_cpu_dispatch()
+{
+  static uint8_t buffer[DISPATCH_SET_SIZE_B];
+  static uint8_t expect[DISPATCH_SET_SIZE_B];
+  static const uint8_t pattern[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+  static const uint16_t lengths[] = { 0, 1, 7, 16, 31, 33, 64, 65, 127, 129, 200, 255 };
+  uint32_t state = 0xD15Au;
+  uint32_t i, l, offset, shift;
+  cpu_isa_t isa, previous;
+  stats_minmaxsum_t mms;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_cpu_dispatch() - up to %s\n", cpu_isa_name(cpu_isa()));
+
+  /* every level up to the one in use - COURSE1_ISA keeps wider ones out */
+  previous = cpu_isa();
+  for (isa = CPU_ISA_SCALAR; isa <= previous; isa++)
+  {
+    cpu_isa_install(isa);
+    for (l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+    {
+      uint32_t length = lengths[l];
+      for (offset = 0; offset < 4; offset++)
+      {
+        /* moves: disjoint, dst above src, dst below src */
+        for (shift = 0; shift < 3; shift++)
+        {
+          uint8_t * src = buffer + DISPATCH_SHIFT_B + offset;
+          uint8_t * dst = (shift == 0) ? (src + (DISPATCH_SET_SIZE_B / 2)) :
+                          (shift == 1) ? (src + 5) : (src - 3 - offset);
+          for (i = 0; i < DISPATCH_SET_SIZE_B; i++)
+          {
+            buffer[i] = (uint8_t)test_random(&state);
+            expect[i] = buffer[i];
+          }
+          for (i = 0; i < length; i++)             /* through a copy - any overlap */
+          {
+            expect[(dst - buffer) + i] = buffer[(src - buffer) + i];
+          }
+          my_memmove(src, dst, length);
+          for (i = 0; i < DISPATCH_SET_SIZE_B; i++)
+          {
+            if (buffer[i] != expect[i]) ret = TEST_ERROR;
+          }
+        }
+
+        /* fill with a 1, 2, 4 and 8 byte pattern */
+        for (shift = 1; shift <= 8; shift *= 2)
+        {
+          my_memzero(buffer, DISPATCH_SET_SIZE_B);
+          my_memset_pattern(buffer + offset, length, pattern, shift);
+          for (i = 0; i < DISPATCH_SET_SIZE_B; i++)
+          {
+            uint8_t want = ((i >= offset) && (i < (offset + length))) ? pattern[(i - offset) % shift] : 0;
+            if (buffer[i] != want) ret = TEST_ERROR;
+          }
+        }
+
+        /* reverse, min / max / sum */
+        for (i = 0; i < DISPATCH_SET_SIZE_B; i++)
+        {
+          buffer[i] = (uint8_t)test_random(&state);
+          expect[i] = buffer[i];
+        }
+        my_reverse(buffer + offset, length);
+        for (i = 0; i < length; i++)
+        {
+          if (buffer[offset + i] != expect[offset + length - 1 - i]) ret = TEST_ERROR;
+        }
+        find_min_max_sum(expect + offset, length, &mms);
+        {
+          uint8_t minimum = (length != 0) ? 0xFF : 0, maximum = 0;
+          uint64_t sum = 0;
+          for (i = 0; i < length; i++)
+          {
+            uint8_t item = expect[offset + i];
+            if (item < minimum) minimum = item;
+            if (item > maximum) maximum = item;
+            sum += item;
+          }
+          if ((mms.minimum != minimum) || (mms.maximum != maximum) || (mms.sum != sum))
+          {
+            ret = TEST_ERROR;
+          }
+        }
+      }
+    }
+  }
+  cpu_isa_install(previous);
+
+  /* fill the binder table - past its end a module is bound once, not kept */
+  for (l = 0; l < CPU_DISPATCH_MAX_BINDERS; l++)
+  {
+    dispatch_binds = 0;
+    i = (uint32_t)cpu_dispatch_register(dispatch_bind);
+    if (dispatch_binds != 1)
+    {
+      ret = TEST_ERROR;
+    }
+    if (i == 0) break;
+  }
+  dispatch_binds = 0;
+  cpu_isa_install(previous);
+  if ((l == CPU_DISPATCH_MAX_BINDERS) || (dispatch_binds != l))
+  {
+    ret = TEST_ERROR;
+  }
+  return ret;
+}
+
+static char trace_text[TRACE_TEST_TEXT_SIZE];   /* what test_trace's sink got */
+static char trace_last[TRACE_TEST_TEXT_SIZE];   /* last line it got */
+static uint32_t trace_text_length;
+static uint32_t trace_lines;
+
+static void trace_capture(const char * text, size_t length)
+{
+  size_t i;
+
+  for (i = 0; (i < length) && (trace_text_length < (TRACE_TEST_TEXT_SIZE - 1)); i++)
+  {
+    trace_text[trace_text_length++] = text[i];
+  }
+  trace_text[trace_text_length] = '\0';
+  if (length >= TRACE_TEST_TEXT_SIZE) length = TRACE_TEST_TEXT_SIZE - 1;
+  my_memcopy((uint8_t *)text, (uint8_t *)trace_last, length);
+  trace_last[length] = '\0';
+  trace_lines++;
+}
+
+static int8_t trace_equal(const char * text, const char * expect)
+{
+  while ((*text != '\0') && (*text == *expect))
+  {
+    text++;
+    expect++;
+  }
+  return (*text == *expect);
+}
+
+int8_t test_trace()
+{
+  static const trace_format_t cut = { "%d-%d" };
+  const trace_arg_t args[TRACE_MAX_ARGS] = { 12345, 678, 0, 0, 0, 0 };
+  char text[6];
+  trace_sink_t previous;
+  unsigned long dropped;
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_trace()\n");
+  trace_flush();                                /* earlier records to the old sink */
+  previous = trace_sink_install(trace_capture);
+  trace_text_length = 0;
+  trace_lines = 0;
+
+  /* arguments cast back to the type of their conversion */
+  TRACE("%d %u %x %04X |%-3s|\n", -42, 42u, 255, 255, "ab");
+  TRACE("%lu %c 100%% %s %lld\n", 4294967295UL, 'x', NULL, -5LL);
+  if ((trace_flush() != 2) || (trace_lines != 2) ||
+      !trace_equal(trace_text, "-42 42 ff 00FF |ab |\n4294967295 x 100% (null) -5\n"))
+  {
+    ret = TEST_ERROR;
+  }
+  if ((trace_format(&cut, args, text, sizeof(text)) != 5) || !trace_equal(text, "12345"))
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* a full ring drops new records and the next flush reports them */
+  trace_text_length = 0;
+  trace_lines = 0;
+  dropped = trace_dropped();
+  for (i = 0; i < (TRACE_RING_SIZE + 3); i++)
+  {
+    TRACE("%u\n", i);
+  }
+  if ((trace_dropped() - dropped) != 3)
+  {
+    ret = TEST_ERROR;
+  }
+  if ((trace_flush() != TRACE_RING_SIZE) || (trace_lines != (TRACE_RING_SIZE + 1)) ||
+      !trace_equal(trace_last, "trace: 3 records dropped\n") ||
+      (trace_text[0] != '0') || (trace_text[1] != '\n') || (trace_text[2] != '1'))
+  {
+    ret = TEST_ERROR;
+  }
+
+  trace_sink_install(previous);
+  return ret;
+}
+
+static char print_text[PRINT_TEST_TEXT_SIZE];   /* what test_stats_print's writer got */
+static uint32_t print_text_length;              /* all bytes got, also those cut off */
+static uint32_t print_writes;
+static uint32_t print_longest;                  /* longest piece */
+
+static void print_capture(const char * text, size_t length)
+{
+  size_t i;
+
+  for (i = 0; i < length; i++, print_text_length++)
+  {
+    if (print_text_length < (PRINT_TEST_TEXT_SIZE - 1)) print_text[print_text_length] = text[i];
+  }
+  print_text[(print_text_length < PRINT_TEST_TEXT_SIZE) ? print_text_length : (PRINT_TEST_TEXT_SIZE - 1)] = '\0';
+  print_writes++;
+  if (length > print_longest) print_longest = (uint32_t)length;
+}
+
+static void print_reset(void)
+{
+  print_text[0] = '\0';
+  print_text_length = 0;
+  print_writes = 0;
+  print_longest = 0;
+}
+
+/* Appends text (and value padded to width, if text is NULL) to expect */
+static void print_expect(char * expect, uint32_t * length, const char * text,
+                         uint32_t value, uint32_t width)
+{
+  uint8_t digits[12];
+  uint32_t i = 0;
+
+  if (text == NULL)
+  {
+    my_itoa((int32_t)value, digits, BASE_10);
+    text = (const char *)digits;
+  }
+  for (; text[i] != '\0'; i++)
+  {
+    expect[(*length)++] = text[i];
+  }
+  for (; i < width; i++)
+  {
+    expect[(*length)++] = ' ';
+  }
+  expect[*length] = '\0';
+}
+
+#if defined (VERBOSE) && defined (HOST)
+/* print_array of set in rows of columns, every stride-th item */
+static int8_t print_check_array(const uint8_t * set, uint32_t length, uint32_t columns,
+                                uint32_t stride, char * expect)
+{
+  uint32_t expect_length = 0;
+  uint32_t i;
+  uint32_t column = 0;
+
+  print_expect(expect, &expect_length, "\n\nData array: ", 0, 0);
+  if (stride > 1)
+  {
+    print_expect(expect, &expect_length, "every ", 0, 0);
+    print_expect(expect, &expect_length, NULL, stride, 0);
+    print_expect(expect, &expect_length, ". of ", 0, 0);
+    print_expect(expect, &expect_length, NULL, length, 0);
+    print_expect(expect, &expect_length, " items", 0, 0);
+  }
+  for (i = 0; i < length; i += stride)
+  {
+    if (column == 0) print_expect(expect, &expect_length, "\n\t", 0, 0);
+    print_expect(expect, &expect_length, NULL, set[i], 3);
+    print_expect(expect, &expect_length, " ", 0, 0);
+    if (++column == columns) column = 0;
+  }
+  print_expect(expect, &expect_length, "\n", 0, 0);
+
+  print_reset();
+  print_array((uint8_t *)set, length);
+  if ((print_text_length != expect_length) || !trace_equal(print_text, expect) ||
+      (print_writes != ((expect_length + STATS_PRINT_BUFFER_SIZE - 1) / STATS_PRINT_BUFFER_SIZE)) ||
+      (print_longest > STATS_PRINT_BUFFER_SIZE))
+  {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+#endif
+
+int8_t test_stats_print()
+{
+  static uint8_t set[PRINT_TEST_SET_SIZE];
+  static char expect[PRINT_TEST_TEXT_SIZE];
+  static stats_result_t result;
+  static const stats_print_options_t summary = { STATS_PRINT_SUMMARY, 0, 0 };
+#if defined (VERBOSE) && defined (HOST)
+  static const stats_print_options_t rows = { STATS_PRINT_ALL, 16, 0 };
+  static const stats_print_options_t sampled = { STATS_PRINT_SAMPLED, 0, 300 };
+#endif
+  const stats_print_options_t * previous_options;
+  stats_writer_t previous;
+  uint32_t expect_length = 0;
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+
+  TRACE("test_stats_print()\n");
+  previous = stats_writer_install(print_capture);
+  previous_options = stats_print_install(&summary);
+
+  for (i = 0; i < PRINT_TEST_SET_SIZE; i++)
+  {
+    set[i] = (uint8_t)(i * 37);
+  }
+
+  /* lengths and means above INT32_MAX take the long way in out_number;
+   * the summary mode prints the length only and never reads the set */
+  result.median = 7;
+  result.mean = 3000000000UL;
+  result.maximum = 9;
+  result.minimum = 2;
+  print_expect(expect, &expect_length, "\n*** DATA ARRAY STATISTICAL ANALYSIS ***\n\n"
+                                       "\nData array of size 4000000000\n", 0, 0);
+#if defined (VERBOSE) && defined (HOST)
+  print_expect(expect, &expect_length, "\n\nData array: 4000000000 items\n", 0, 0);
+#endif
+  print_expect(expect, &expect_length, "\nMedian = 7\n\nMean   = 3000000000"
+                                       "\n\nMax    = 9\n\nMin    = 2\n", 0, 0);
+  print_reset();
+  print_statistics_result(set, 4000000000UL, &result);
+  if ((print_writes != 1) || (print_text_length != expect_length) ||
+      !trace_equal(print_text, expect))
+  {
+    ret = TEST_ERROR;
+  }
+
+#if defined (VERBOSE) && defined (HOST)
+  /* every item - more text than one print buffer */
+  stats_print_install(&rows);
+  ret |= print_check_array(set, PRINT_TEST_SET_SIZE, 16, 1, expect);
+  if (print_text_length <= STATS_PRINT_BUFFER_SIZE)
+  {
+    ret = TEST_ERROR;
+  }
+
+  /* every 7th item of 2000 for 300 samples, default columns */
+  stats_print_install(&sampled);
+  ret |= print_check_array(set, PRINT_TEST_SET_SIZE, STATS_PRINT_COLUMNS,
+                           (PRINT_TEST_SET_SIZE + 299) / 300, expect);
+
+  /* default options - every item */
+  stats_print_install(NULL);
+  ret |= print_check_array(set, 25, STATS_PRINT_COLUMNS, 1, expect);
+#else
+  /* print_array prints nothing */
+  print_reset();
+  print_array(set, PRINT_TEST_SET_SIZE);
+  if (print_writes != 0)
+  {
+    ret = TEST_ERROR;
+  }
+#endif
+
+  stats_print_install(previous_options);
+  if (stats_writer_install(NULL) != print_capture)
+  {
+    ret = TEST_ERROR;
+  }
+  stats_writer_install(previous);
+  return ret;
+}
+
+/* Scratch memory for the tests - reserve_words takes from here, no heap */
+static uint32_t course1_scratch[COURSE1_ARENA_SIZE_W];
+
+void course1(void) 
+{
+  uint8_t i;
+  int8_t failed = 0;
+  int8_t results[TESTCOUNT];
+  int8_t (*tests[TESTCOUNT])(void) = { test_data1, test_data2, test_itoa_batch,
+                                       test_atoi_parse,
+                                       test_memmove1, test_memmove2, test_memmove3,
+                                       test_memmove_clear,
+                                       test_memcopy, test_memset, test_reverse,
+                                       test_arena, test_pool,
+                                       test_sort_array, test_median, test_rank_percentile,
+                                       test_stats_stream,
+                                       test_stats_parallel, test_stats_generic,
+                                       test_stats_select,
+                                       test_radix_sort, test_parallel_sort,
+                                       test_cpu_dispatch, test_trace,
+                                       test_stats_print };
+  mem_arena_t arena;
+  mem_arena_t * previous;
+
+  arena_init(&arena, (uint8_t *)course1_scratch, sizeof(course1_scratch));
+  previous = arena_install(&arena);
+
+  for ( i = 0; i < TESTCOUNT; i++)
+  {
+    results[i] = tests[i]();
+    arena_reset(&arena);
+    trace_flush();                      /* decode the test's trace before the next one */
+  }
 
-  results[0] = test_data1();
-  results[1] = test_data2();
-  results[2] = test_memmove1();
-  results[3] = test_memmove2();
-  results[4] = test_memmove3();
-  results[5] = test_memcopy();
-  results[6] = test_memset();
-  results[7] = test_reverse();
+  arena_install(previous);
 
   for ( i = 0; i < TESTCOUNT; i++) 
   {
     failed += results[i];
   }
 
-  PRINTF("--------------------------------\n");
-  PRINTF("Test Results:\n");
-  PRINTF("  PASSED: %d / %d\n", (TESTCOUNT - failed), TESTCOUNT);
-  PRINTF("  FAILED: %d / %d\n", failed, TESTCOUNT);
-  PRINTF("--------------------------------\n");
+  TRACE("--------------------------------\n");
+  TRACE("Test Results:\n");
+  TRACE("  PASSED: %d / %d\n", (TESTCOUNT - failed), TESTCOUNT);
+  TRACE("  FAILED: %d / %d\n", failed, TESTCOUNT);
+  TRACE("--------------------------------\n");
+  trace_flush();
 }
@@ -0,0 +1,110 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <cpu_dispatch.c>
+ * @brief  <Run time selection of the SIMD kernels (x86 HOST)>
+ *
+ * <This file contains the CPU feature detection and the list of modules whose
+ *  kernels are rebound by cpu_isa_install.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "cpu_dispatch.h"
+#include "trace.h"
+
+static const char * const cpu_isa_names[CPU_ISA_COUNT] = {
+    "scalar", "sse2", "ssse3", "avx2", "avx512"
+};
+
+static unsigned char cpu_isa_ready = 0;            // cpu_isa_current set
+static cpu_isa_t     cpu_isa_current = CPU_ISA_SCALAR;
+
+static cpu_bind_fn_t cpu_binders[CPU_DISPATCH_MAX_BINDERS];
+static unsigned int  cpu_binder_count = 0;
+
+
+
+cpu_isa_t cpu_isa_supported(void){
+#if defined (CPU_DISPATCH_X86)
+    __builtin_cpu_init();                          // needed before main (constructors)
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")){
+        return CPU_ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))  return CPU_ISA_AVX2;
+    if (__builtin_cpu_supports("ssse3")) return CPU_ISA_SSSE3;
+    if (__builtin_cpu_supports("sse2"))  return CPU_ISA_SSE2;
+#endif
+    return CPU_ISA_SCALAR;
+}
+
+
+
+cpu_isa_t cpu_isa(void){
+    if (!cpu_isa_ready){
+        const char * forced = getenv(CPU_ISA_ENV);
+        cpu_isa_t isa;
+
+        cpu_isa_current = cpu_isa_supported();
+        for (isa = CPU_ISA_SCALAR; (forced != NULL) && (isa < CPU_ISA_COUNT); isa++){
+            if (strcmp(forced, cpu_isa_names[isa]) == 0){
+                if (isa < cpu_isa_current) cpu_isa_current = isa;
+                break;
+            }
+        }
+        if ((forced != NULL) && (isa == CPU_ISA_COUNT)){      // a typo must not go unnoticed
+            TRACE("cpu_dispatch: unknown %s=%s ignored, using %s\n", CPU_ISA_ENV, forced,
+                  cpu_isa_names[cpu_isa_current]);
+        }
+        cpu_isa_ready = 1;
+    }
+    return cpu_isa_current;
+}
+
+
+
+cpu_isa_t cpu_isa_install(cpu_isa_t isa){
+    cpu_isa_t previous = cpu_isa();
+    cpu_isa_t supported = cpu_isa_supported();
+    unsigned int i;
+
+    cpu_isa_current = (isa < supported) ? isa : supported;
+    for (i=0; i<cpu_binder_count; i++){
+        cpu_binders[i](cpu_isa_current);
+    }
+    return previous;
+}
+
+
+
+int cpu_dispatch_register(cpu_bind_fn_t bind){
+    int registered = 0;
+
+    if (cpu_binder_count < CPU_DISPATCH_MAX_BINDERS){
+        cpu_binders[cpu_binder_count++] = bind;
+        registered = 1;
+    }else{
+        TRACE("cpu_dispatch: more than %d modules, one stays at %s\n",
+              CPU_DISPATCH_MAX_BINDERS, cpu_isa_names[cpu_isa()]);
+    }
+    bind(cpu_isa());
+    return registered;
+}
+
+
+
+const char * cpu_isa_name(cpu_isa_t isa){
+    return ((unsigned int)isa < CPU_ISA_COUNT) ? cpu_isa_names[isa] : "?";
+}
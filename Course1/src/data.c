@@ -19,264 +19,246 @@
 #endif
 
 
-/*------------------- bin_1s_comp ------------------------------------------------*
- *
- * This function is private - not visible to public - not declared in header file
- * This function inverts ascii data stored in a buffer from '0'
- * to '1' and vice versa. Hence called the 1's compliment
- *
- * @param buff_start_addr    : Pointer to buffer start address
- * @param bit_size           : buffer size - no of bits in data (0b11001 - 5bits)
- *
- * @return                   : void
+/*------------------- digit_chars -----------------------------------------------*
  *
+ * ASCII char of each digit value 0 - 15 (one nibble)
  *-------------------------------------------------------------------------------*/
-void bin_1s_comp(uint8_t * buff_start_addr, uint8_t bit_size){
-    // invert all to bits - 1st complement
-
-    for (int i=0; i<bit_size; i++){                            // loop through all bits
-        
-        if ((*(buff_start_addr+i)) == '1'){                    // check if bit value is 1
-            *(buff_start_addr+i) = '0';                        // change bit value to 0 if 1    
-        }else{                                                 // if bit value is 0 change to 1
-            *(buff_start_addr+i) = '1';
-        }
-    }
-}
+static const uint8_t digit_chars[16] = {
+    '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
+};
+
 
 
 
-/*------------------- bin_add_one ------------------------------------------------*
+/*------------------- digit_value ------------------------------------------------*
  *
  * This function is private - not visible to public - not declared in header file
  *
- * This function performes binary addition of 1 to a binary data stored as ascii 
- * in buffer. 
- * Starting from the least bit, '1's are changed to '0' until it reaches a bit
- * which is '0'. This bit is then changed to '1' and the loop stops.
+ * This function converts one ascii char to its digit value.
+ * '0' - '9' -> 0 - 9, 'A' - 'F' / 'a' - 'f' -> 10 - 15, anything else -> 0xFF
  *
- * @param buff_start_addr    : Pointer to buffer start address
- * @param bit_size           : buffer size - no of bits in data (0b11001 - 5bits)
+ * @param ascii : unsigned 8byte integer which stores char
  *
- * @return                   : void
+ * @return      : digit value, 0xFF if the char is not a digit
  *
  *-------------------------------------------------------------------------------*/
-void bin_add_one(uint8_t * buff_start_addr, uint8_t bit_size){
-    // add 1  to binary data
-    
-    for (int i=0; i<bit_size; i++){
-    
-        if ((*(buff_start_addr+i)) == '0'){       // check if bit contains '0' else continue loop
-            *(buff_start_addr+i) = '1';           // change bit value from 0 to 1
-            break;                                // stop loop if bit original was 0
-        }else{                                    // continue loop if bit is not '0'
-            *(buff_start_addr+i) = '0';           // change bit value from '1' to '0'
+static uint8_t digit_value(uint8_t ascii){
 
-        }
-    }
+    uint8_t lower = ascii | 0x20;                           // fold 'A'-'F' onto 'a'-'f'
+
+    if ((uint8_t)(ascii - '0') < 10) return (uint8_t)(ascii - '0');
+    if ((uint8_t)(lower - 'a') < 6)  return (uint8_t)(lower - 'a' + 10);
+    return 0xFF;
 }
 
 
 
-/*------------------- bin_2s_comp ------------------------------------------------*
- *
- * This function is private - not visible to public - not declared in header file
- *
- * This function performes 2's compliment - (negative integer in binary form)
- *
- * it is done using two steps
- * 	1st complement - invert all to bits   - use function: bin_1s_comp 
- * 	2nd complement - add 1 to binary data - use function: bin_add_one
- *
- * @param buff_start_addr    : Pointer to buffer start address
- * @param bit_size           : buffer size - no of bits in data (0b11001 - 5bits)
- *
- * @return                   : void
+
+/*------------------- pow10_table -----------------------------------------------*
  *
+ * Powers of ten which fit in 32 bits - used to count decimal digits
  *-------------------------------------------------------------------------------*/
-void bin_2s_comp(uint8_t * buff_start_addr, uint8_t bit_size){
-    // Performs the binary 2's complement operation
-     
-    bin_1s_comp(buff_start_addr, bit_size); // 1st complement - invert all to bits
-    bin_add_one(buff_start_addr, bit_size); // add 1 to binary data - 2nd complement
+static const uint32_t pow10_table[10] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+    1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
 
-}
 
+/*------------------- dec_digit_pairs --------------------------------------------*
+ *
+ * "00" to "99" - two decimal digits per entry, entry n at index 2n
+ *-------------------------------------------------------------------------------*/
+static const uint8_t dec_digit_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
 
 
-/*------------------- int_2_ascii ------------------------------------------------*
+
+/*------------------- count_digits ------------------------------------------------*
  *
  * This function is private - not visible to public - not declared in header file
  *
- * This function converts integer to ascii. Integers 0 - 9 are converted by adding
- * 0x30 to get the corresponding ascii byte
- *
- * Integers 10 -15 are converted directly by coding
+ * This function returns the number of digits of an unsigned value in a base
+ * without converting it.
  *
+ *   base 2, 4, 8, 16 : significant bits (clz) divided by bits per digit
+ *   base 10          : log10 estimate from significant bits (x 1233 / 4096)
+ *                      corrected with one power of ten table lookup
+ *   other bases      : repeated division
  *
- * @param integer : unsigned 8byte integer
+ * @param value  : uint32_t value to be converted
+ * @param base   : uint32_t base - target base
  *
- * @return        : unsigned 8byte integer type which stores char
+ * @return       : number of digits (1 for value 0)
  *
  *-------------------------------------------------------------------------------*/
-uint8_t int_2_ascii(uint8_t integer){
-
-    switch(integer){
-        case 10: return 'A';
-        case 11: return 'B';
-        case 12: return 'C';
-        case 13: return 'D';
-        case 14: return 'E';
-        case 15: return 'F';
-        default:                          // for all remainder below 10 (0-9)
-            return (integer + 0x30);      // convert remainder to ascii from integer
+static uint8_t count_digits(uint32_t value, uint32_t base){
+
+    uint32_t bits = 32 - (uint32_t)__builtin_clz(value | 1);    // significant bits (>= 1)
+    uint32_t digit_bits;
+    uint8_t digits;
+
+    if ((base & (base - 1)) == 0){                              // power of two base
+        digit_bits = (uint32_t)__builtin_ctz(base);             // bits per digit
+        return (uint8_t)((bits + digit_bits - 1) / digit_bits);
     }
 
-}
+    if (base == 10){
+        uint32_t t = (bits * 1233) >> 12;                       // ~ bits * log10(2)
+        return (uint8_t)(t + 1 - ((value | 1) < pow10_table[t]));
+    }
 
+    digits = 1;
+    while (value >= base){
+        value /= base;
+        digits++;
+    }
+    return digits;
+}
 
 
 
-/*------------------- ascii_2_int ------------------------------------------------*
+/*------------------- write_dec_digits ------------------------------------------*
  *
  * This function is private - not visible to public - not declared in header file
  *
- * This function converts ascii to integer. Integers 0 - 9 are converted by subtracting
- * 0x30 to get the corresponding integer
- *
- * Integers 10 -15 are converted directly by coding
+ * This function writes the decimal digits of a value backwards, ending just
+ * before buff_end. Two digits are produced per division by 100 and copied
+ * from dec_digit_pairs; a last single digit is added directly.
+ * The caller must have counted the digits (count_digits) to place buff_end.
  *
+ * @param buff_end : Pointer to one past the last digit
+ * @param value    : uint32_t value to be converted
  *
- * @param integer : unsigned 8byte integer which stores char
- *
- * @return        : unsigned 8byte integer 
+ * @return         : void
  *
  *-------------------------------------------------------------------------------*/
+static void write_dec_digits(uint8_t * buff_end, uint32_t value){
 
-uint8_t ascii_2_int(uint8_t ascii){
-
-    switch(ascii){
-        case 'A': return 10;
-        case 'B': return 11;
-        case 'C': return 12;
-        case 'D': return 13;
-        case 'E': return 14;
-        case 'F': return 15;
-        default:                      // for all remainder below 10 (0-9)
-            return (ascii - 0x30);    // convert remainder to ascii from integer
-    }
+    const uint8_t * pair;
 
+    while (value >= 100){
+        pair = &dec_digit_pairs[(value % 100) * 2];        // last two digits
+        value /= 100;
+        *(--buff_end) = pair[1];
+        *(--buff_end) = pair[0];
+    }
+    if (value >= 10){                                       // two digits left
+        pair = &dec_digit_pairs[value * 2];
+        *(--buff_end) = pair[1];
+        *(--buff_end) = pair[0];
+    }else{                                                  // one digit left
+        *(--buff_end) = (uint8_t)('0' + value);
+    }
 }
 
 
 
-
-/*------------------- my_pow ------------------------------------------------*
+/*------------------- write_pow2_digits -----------------------------------------*
  *
  * This function is private - not visible to public - not declared in header file
  *
- * This function performs the power multiplication of a given base (2^^3) = 8
- *
+ * This function writes the digits of a value in a power of two base backwards,
+ * ending just before buff_end. Each digit is the low digit_bits bits of the
+ * value (mask), looked up in digit_chars, then the value is shifted down.
+ * Negative numbers are passed as their uint32_t bit pattern, so no two's
+ * complement work is needed.
  *
- * @param base  : int32_t (2)
- * @param power : int32_t (3)
+ * @param buff_end   : Pointer to one past the last digit
+ * @param value      : uint32_t value (bit pattern) to be converted
+ * @param digit_bits : bits per digit - 1 (base 2), 3 (base 8), 4 (base 16)
  *
- * @return      : int32_t (8)
+ * @return           : void
  *
  *-------------------------------------------------------------------------------*/
-int32_t my_pow(int32_t base, uint32_t power){
-    int32_t res=0;               // store the result of multiplication
-    
-    if (power==0){               // example: 2^^0 = 1
-        res = 1;                 
-    }else if (power==1){         // example: 2^^1 = 2
-        res = base;
-    }else{
-        res = 1;                 // set result to 1 for multiplication
-        while(power != 0){       // example: 2^^2 = 4
-            res *= base;	 // add multiplication result until power value is 0
-            power--;             // update power value after multiplication
-        }
-    }
-    return res;
+static void write_pow2_digits(uint8_t * buff_end, uint32_t value, uint32_t digit_bits){
 
-}
+    uint32_t digit_mask = (1UL << digit_bits) - 1;
 
+    do{
+        *(--buff_end) = digit_chars[value & digit_mask];
+        value >>= digit_bits;
+    }while (value != 0);
+}
 
 
 
-/*------------------- int_2_base_digits ------------------------------------------------*
+/*------------------- base_symbol_of ---------------------------------------------*
  *
  * This function is private - not visible to public - not declared in header file
  *
- * This function performes convertion from integer to base digits.
- * 5 (base10) = 0101 (base2)
- * 5 (base10) = 0x05 (base16)
+ * This function returns the char written after '0' in front of the digits of a
+ * base: 'b' (base 2), 'c' (base 8), 'x' (base 16), 0 for bases without prefix.
  *
- * This execution is performed using a buffer as output are stored in ascii char
- * @param buff_addr    : Pointer to buffer start address of type uint8_t
- * @param int_data     : int32_t integer (base10)
- * @param base         : uint32_t base - target base
+ * @param base   : uint32_t base - target base
  *
- * @return             : unsigned 8byte integer which stores length of char in buffer
+ * @return       : base symbol, 0 if none
  *
- *--------------------------------------------------------------------------------------*/
-uint8_t int_2_base_digits(uint8_t * buff_addr, int32_t int_data, uint32_t base){
-
-    uint8_t rem;			   // stores remainder
-    uint8_t data_str_len = 0;              // length of char store in buffer
+ *-------------------------------------------------------------------------------*/
+static uint8_t base_symbol_of(uint32_t base){
 
-    while(int_data != 0){
-        ++buff_addr;                       // Update buffer pointer to next byte address
-        rem  = int_data % base;
-        *buff_addr = int_2_ascii(rem);     // convert to ASCII (+ 0x30) and store in buffer
-        int_data = int_data/base;          // Update data
-        data_str_len++;                    // Updata string size
+    switch (base){
+        case 2:  return 'b';
+        case 8:  return 'c';
+        case 16: return 'x';
+        default: return 0;
     }
-
-    return data_str_len;
 }
 
 
 
-uint8_t binAscii_2_baseAscii(uint8_t * buff_addr, uint8_t bit_size, uint8_t base_size){
-
-    uint8_t base_pow_idx = 0;
-    uint8_t base_res = 0;
-    uint8_t data_str_len = 0;
+/*------------------- write_number -----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * This function writes the string [-][0b|0c|0x]digits of data_str_len chars at
+ * ptr: sign and base symbol from the front, digits backwards from the end.
+ * The caller must have sized the string (count_digits) and writes the '\0'.
+ *
+ * @param ptr          : Pointer to the first char of the string
+ * @param data_str_len : chars of the string, '\0' not included
+ * @param value        : uint32_t magnitude, or bit pattern if base_symbol is set
+ * @param base         : uint32_t base - target base (2 to 16)
+ * @param base_symbol  : 'b', 'c', 'x' or 0 (see base_symbol_of)
+ * @param FLAG_SIGN    : 1 to write a '-'
+ *
+ * @return             : void
+ *
+ *-------------------------------------------------------------------------------*/
+static void write_number(uint8_t * ptr, uint32_t data_str_len, uint32_t value, uint32_t base,
+                         uint8_t base_symbol, uint8_t FLAG_SIGN){
 
-    for(int i=1; i<= bit_size; i++){
-        //printf("\n% d: %c", i, (*(buff_start_addr + i)));
-        base_res += ascii_2_int(*(buff_addr + i)) * my_pow(2,base_pow_idx);
-        *(buff_addr + i) = 0;                 // replace data with 0 after process
-        base_pow_idx++;
-                  
-        if ((base_pow_idx == base_size) || (i==bit_size)){
-            base_pow_idx = 0;                       // reset base power to 0; base16 - (0, 1, 2, 3)
-            data_str_len++;                         // update string count
-            base_res = int_2_ascii(base_res);       // convert int to ascii
-            *(buff_addr + data_str_len) = base_res;
-            base_res = 0;                           // reset base_res for next quad
+    uint8_t * buff = ptr + data_str_len;
 
-        }
+    if (FLAG_SIGN){
+        *ptr++ = '-';                                      // add minus sign to string
     }
-    return data_str_len;
-}
-
-
-
-uint8_t bit_fill_up(uint8_t * buff_addr, uint8_t bit_count, uint8_t bit_size){
-    uint8_t data_str_len=0;
-    
-    while((bit_count+1) <= bit_size){      // next bit count = bit_count + 1
-        *(++buff_addr) = '0';
-        bit_count++;
-        data_str_len++;
+    if (base_symbol){
+        *ptr++ = '0';                                      // adding base symbol
+        *ptr   = base_symbol;
+        write_pow2_digits(buff, value, (uint32_t)__builtin_ctz(base));  // shift & mask
+    }else if (base == 10){
+        write_dec_digits(buff, value);                     // two digits per step
+    }else{
+        do{
+            *(--buff) = digit_chars[value % base];         // least significant digit first
+            value /= base;
+        }while (value != 0);
     }
-return data_str_len;
 }
 
 
+
 /*---------------------------------  my_itoa  -----------------------------------------------*
  * Integer-to-ASCII needs to convert data from a standard integer type into an ASCII string.
  * The number you wish to convert is passed in as a signed 32-bit integer.
@@ -303,156 +285,105 @@ return data_str_len;
 
 uint8_t my_itoa(int32_t data, uint8_t * ptr, uint32_t base){
 // convert from integer to ascii string
- 
-    uint8_t * buff;
-    uint8_t buffer_len = 35;
-    buff = (uint8_t *)malloc(sizeof(uint8_t)*buffer_len);  // reserve data structure on the heap
-    uint8_t * buff_start_addr = buff;                      // store buffer start address
-    int8_t FLAG_SIGN = 0;                                  // 1:-VE ; 0:+VE
-    int8_t data_str_len=0;                                 // data string size
-    uint8_t bit_count =0;
-    uint8_t bit_size =32;
-
-    // update the null pointer
-    *(buff) = '\0';                                        // null to end the buffer
-    data_str_len++;		                           // Update string size (Null)
-    //printf("\nPointer start: %p", buff);
-    //printf("\nBase: %d", base);
-
-    // check if data is positive or negative and update sign flag if negative
-    if ((data != 0) && (data < 1)){
-        FLAG_SIGN=1;                                       // data is negative
-        data *= -1;                                        // convert -ve to +ve   
-    }
 
-    if (data == 0){
-        *(++buff) = 0x30;
-        data_str_len++;
-         
-    }else{
-        data_str_len += int_2_base_digits(buff, data, base);
-        buff = (uint8_t *)(buff_start_addr + (data_str_len-1)); // update the buff to end addr
-        //printf("\n%d", data_str_len);
+    uint32_t value;                                        // magnitude or bit pattern
+    uint8_t base_symbol = 0;                               // 'b', 'c', 'x' - after '0'
+    uint8_t FLAG_SIGN = 0;                                 // 1:-VE ; 0:+VE
+    uint8_t data_str_len;                                  // chars before '\0'
 
+    if ((base < 2) || (base > 16)){                        // unsupported base
+        *ptr = '\0';
+        return 0;
     }
 
-    // check sign flag
-    switch (base){
-        
-        case 2:
-            if (FLAG_SIGN){                             // initiate 2's complement execution
-                
-                // fill  up the bits
-                bit_count = buff - buff_start_addr;     // get no of bits after int2base conversion
-                data_str_len += bit_fill_up(buff, bit_count, bit_size); // fill up bit 32;
-                buff = (uint8_t *)(buff_start_addr + (data_str_len-1)); // update buff to end addr
-
-                // Performs the binary 2's complement operation 
-                bin_2s_comp(buff_start_addr+1, bit_size);               // index 0 contain Null \0
-            }
-            *(++buff) = 'b'; data_str_len++;                            // adding base symbol
-            *(++buff) = '0'; data_str_len++;		                // adding base symbol
-            break;
-
-
-
-        case 8:
-
-            if (FLAG_SIGN){ // operation to be executed in binary and converted back to base
-                
-                data_str_len = 1;                               // reset string count to contain \0
-                buff = (uint8_t *)(buff_start_addr);            // reset buffer to point to null \0
-
-                data_str_len += int_2_base_digits(buff, data, 2);// convert to base digit in binary
-                buff = (uint8_t *)(buff_start_addr + (data_str_len-1)); // update buff to end addr
-
-                // fill up the bits (remaining bits are fill up to 32 bits)
-                bit_count = buff - buff_start_addr;
-                //printf("\n%d", bit_count);
-                data_str_len += bit_fill_up(buff, bit_count, bit_size); // fill up bit 32;
-
-                // Performs the binary 2's complement operation 
-                bin_2s_comp(buff_start_addr+1, bit_size);  // index 0 contain Null \0
-
-                // convert back to base 8
-                data_str_len = 1;                               // reset string count to contain \0
-                data_str_len += binAscii_2_baseAscii(buff_start_addr, bit_size, 3);
-                buff = (uint8_t *)(buff_start_addr + (data_str_len-1)); // update buff to end addr
-
-            }
-            *(++buff) = 'c'; data_str_len++;                              // adding base symbol
-            *(++buff) = '0'; data_str_len++;		                  // adding base symbol
-            break;
-
+    base_symbol = base_symbol_of(base);
+    if (base_symbol){
+        value = (uint32_t)data;                            // -ve: 2's complement bit pattern
+    }else{
+        FLAG_SIGN = (data < 0);
+        value = FLAG_SIGN ? (0U - (uint32_t)data) : (uint32_t)data;  // safe for INT32_MIN
+    }
 
-        case 16:
+    // string length is known up front: [-][0b|0c|0x]digits
+    data_str_len = FLAG_SIGN + (base_symbol ? 2 : 0) + count_digits(value, base);
 
-            if (FLAG_SIGN){
-                // 2's complement execution
-                data_str_len = 1;                               // reset string count to contain \0
-                buff = (uint8_t *)(buff_start_addr);            // reset buffer to point to null \0
-                data_str_len += int_2_base_digits(buff, data, 2);// convert to base digit in binary
-                buff = (uint8_t *)(buff_start_addr + (data_str_len-1)); // update buff to end addr
+    // write from the end of the string backwards - no scratch buffer
+    ptr[data_str_len] = '\0';                              // null to end the string
+    write_number(ptr, data_str_len, value, base, base_symbol, FLAG_SIGN);
 
-                // fill  up the bits
-                bit_count = buff - buff_start_addr;
-                data_str_len += bit_fill_up(buff, bit_count, bit_size); // fill up bit 32;
+    return data_str_len + 1;                               // length including '\0'
 
-               // Performs the binary 2's complement operation 
-               bin_2s_comp(buff_start_addr+1, bit_size);      // index 0 contain Null \0
+}
 
-               // convert back to base 16
-               data_str_len = 1;                               // reset string count to contain \0
-               buff = (uint8_t *)(buff_start_addr);            // reset buffer to point to null \0
-               data_str_len += binAscii_2_baseAscii(buff, bit_size, 4);
-               buff = (uint8_t *)(buff_start_addr + (data_str_len-1)); // update the buff
-            }
-            *(++buff) = 'x'; data_str_len++;                              // adding base symbol
-            *(++buff) = '0'; data_str_len++;		                  // adding base symbol
-            break;
 
 
-        case 10:
-            if (FLAG_SIGN){
-                *(++buff) = '-';             // add minus sign to string
-                data_str_len++;              // Updata string size
-            }
-            break;
-        default:
-            NULL;
-    }
-    
+/*---------------------------------  my_itoa_batch  -----------------------------------------*
+ *
+ * Integer-to-ASCII of a whole array, strings as written by my_itoa packed one after
+ * the other into out, each ended by '\0'; offsets[i] is where string i starts.
+ *
+ * Two passes: the first only counts digits (count_digits), so every offset and the
+ * total size are known before anything is written; the second writes each string
+ * in place (write_number). The base checks and prefix are done once per array and
+ * no scratch buffer or copy is needed.
+ *
+ * @param in      : const int32_t * - integers to be converted
+ * @param n       : size_t          - no of integers
+ * @param base    : uint32_t        - target base (2 to 16)
+ * @param out     : uint8_t *       - buffer for the strings, NULL to only get the size
+ * @param cap     : size_t          - size of out in bytes
+ * @param offsets : uint32_t *      - n offsets into out (may be NULL if out is NULL
+ *                                    or n = 0)
+ *
+ * @return        : size_t          - bytes used in out (all '\0' included), 0 for
+ *                                    n = 0, ITOA_BATCH_ERROR if base is outside 2 to
+ *                                    16, offsets is missing or cannot hold an offset
+ *                                    or out is too small (out is then not written)
+ *--------------------------------------------------------------------------------------------*/
 
-/*  This section copies the ascii char from buff to ptr in reverse other
- *  but this operation has been replaced with following functions
- *  my_reverse & my_memcopy
-
-    // ** code starts here **
-    printf("\nPointer before: %p, %c", (buff), *(buff));
-    printf("\nFUNC ASCII: ");
-    while((*(buff)) != '\0'){
-        printf("%c", *(buff));      // copy to ascii char to ptr addr
-        *ptr = *(buff);
-        //printf("\nPointer return: %p", (buff));
-        ptr++; buff--;    
+size_t my_itoa_batch(const int32_t * in, size_t n, uint32_t base,
+                     uint8_t * out, size_t cap, uint32_t * offsets){
+
+    uint8_t base_symbol;                                   // 'b', 'c', 'x' - after '0'
+    uint8_t prefix_len;
+    uint8_t FLAG_SIGN;                                     // 1:-VE ; 0:+VE
+    uint32_t value;                                        // magnitude or bit pattern
+    size_t total = 0;                                      // bytes of all strings
+    size_t end;
+    size_t i;
+
+    if ((base < 2) || (base > 16)) return ITOA_BATCH_ERROR; // unsupported base
+    if ((out != NULL) && (n > 0) && (offsets == NULL)) return ITOA_BATCH_ERROR;
+
+    base_symbol = base_symbol_of(base);
+    prefix_len = base_symbol ? 2 : 0;
+
+    // pass 1 - sizes only, the offsets are the running total
+    for (i=0; i<n; i++){
+        value = (uint32_t)in[i];
+        FLAG_SIGN = !base_symbol && (in[i] < 0);
+        if (FLAG_SIGN) value = 0U - value;                 // safe for INT32_MIN
+        if (offsets != NULL){
+            if (total > 0xFFFFFFFFUL) return ITOA_BATCH_ERROR;    // offset does not fit
+            offsets[i] = (uint32_t)total;
+        }
+        total += FLAG_SIGN + prefix_len + count_digits(value, base) + 1;
     }
-    *ptr = *(buff);                //  copy NULL char to ptr
-
-*/
-    //printf("\n\nPointer exit: %p", buff);
-
-/*
-    for(int i=0; i<= 35; i++){
-        printf("\n%d: %c", i, (*(buff_start_addr + i)));
+    if (out == NULL) return total;                         // size query
+    if (total > cap) return ITOA_BATCH_ERROR;
+
+    // pass 2 - each string written in place, its end is the next offset
+    for (i=0; i<n; i++){
+        value = (uint32_t)in[i];
+        FLAG_SIGN = !base_symbol && (in[i] < 0);
+        if (FLAG_SIGN) value = 0U - value;
+        end = ((i + 1) < n) ? offsets[i + 1] : total;
+        out[end - 1] = '\0';
+        write_number(out + offsets[i], (uint32_t)(end - 1 - offsets[i]), value, base,
+                     base_symbol, FLAG_SIGN);
     }
-*/
-    my_reverse(buff_start_addr, data_str_len);     // reverse the other of data in buff
-                                                   // ['\0', '1', '1', '4'] ->  '4','1','1','\0'
-    my_memcopy(buff_start_addr, ptr, data_str_len);// copy ascii chars from buff to ptr addr
-    free((void *)buff_start_addr);                 // make buffer available again for use
-
-    return data_str_len;
 
+    return total;
 }
 
 
@@ -487,6 +418,88 @@ void test_itoa( int32_t data, uint8_t * ptr, uint32_t base){
 
 
 
+/*---------------------------------  my_atoi_parse  -----------------------------------------*
+ *
+ * ASCII-to-Integer parser. Reads [-][0b|0c|0x]digits from the start of the string and
+ * stops at the first char which is not a digit of the base, so no digit count is needed.
+ *
+ * Digits are accumulated left to right (Horner: value = value * base + digit) with a
+ * checked multiply and add, so numbers which do not fit in 32 bits are reported instead
+ * of wrapping around.
+ *
+ *   base 2, 8, 16 : digits are the 32-bit two's complement pattern (as made by my_itoa),
+ *                   0 - 0xFFFFFFFF fit; with '-' the magnitude must be <= 2^31
+ *   other bases   : [-] digits, INT32_MIN - INT32_MAX fit
+ *
+ * @param ptr      : uint8_t * - Pointer to buffer which stores the ascii char
+ * @param base     : uint32_t  - target base
+ * @param value    : int32_t * - result, saturated to INT32_MIN / INT32_MAX on overflow
+ * @param overflow : uint8_t * - set to 1 on overflow, else 0 (may be NULL)
+ *
+ * @return         : size_t    - number of bytes consumed, 0 if no digit was found
+ *--------------------------------------------------------------------------------------------*/
+
+size_t my_atoi_parse(const uint8_t * ptr, uint32_t base, int32_t * value, uint8_t * overflow){
+
+    const uint8_t * start_ptr = ptr;                   // store buffer start address
+    const uint8_t * digit_ptr;
+    uint8_t FLAG_SIGN = 0;                             // 1:-VE ; 0:+VE
+    uint8_t FLAG_OVERFLOW = 0;
+    uint8_t base_symbol;                               // 'b', 'c', 'x' - after '0'
+    uint32_t res = 0;                                  // magnitude or bit pattern
+    uint32_t limit;                                    // largest value that fits
+    uint8_t digit;
+
+    *value = 0;
+    if (overflow != NULL) *overflow = 0;
+    if ((base < 2) || (base > 16)) return 0;           // unsupported base
+
+    base_symbol = base_symbol_of(base);
+
+    if (*ptr == '-'){
+        FLAG_SIGN = 1;
+        ptr++;
+    }
+
+    // skip the base symbol, only if a digit follows it
+    if (base_symbol && (ptr[0] == '0') && ((ptr[1] | 0x20) == base_symbol) &&
+        (digit_value(ptr[2]) < base)){
+        ptr += 2;
+    }
+
+    // Horner - one checked multiply and add per digit
+    digit_ptr = ptr;
+    while ((digit = digit_value(*ptr)) < base){
+        if (__builtin_mul_overflow(res, base, &res) ||
+            __builtin_add_overflow(res, (uint32_t)digit, &res)){
+            FLAG_OVERFLOW = 1;
+        }
+        ptr++;
+    }
+    if (ptr == digit_ptr) return 0;                    // no digits
+
+    // range of the signed result
+    if (FLAG_SIGN){
+        limit = 0x80000000UL;                          // -INT32_MIN
+    }else if (base_symbol){
+        limit = 0xFFFFFFFFUL;                          // two's complement pattern
+    }else{
+        limit = 0x7FFFFFFFUL;                          // INT32_MAX
+    }
+    if (res > limit) FLAG_OVERFLOW = 1;
+
+    if (FLAG_OVERFLOW){
+        *value = FLAG_SIGN ? INT32_MIN : INT32_MAX;
+        if (overflow != NULL) *overflow = 1;
+    }else{
+        *value = (int32_t)(FLAG_SIGN ? (0U - res) : res);
+    }
+
+    return (size_t)(ptr - start_ptr);
+}
+
+
+
 /*---------------------------------  my_atoi  -----------------------------------------------*
  *
  * ASCII-to-Integer needs to convert data back from an ASCII represented string into an 
@@ -499,6 +512,9 @@ void test_itoa( int32_t data, uint8_t * ptr, uint32_t base){
  *
  * This function needs to handle signed data.
  *
+ * Parsing stops at the first non-digit (see my_atoi_parse), digits is kept for
+ * compatibility and is not needed.
+ *
  * @param ptr     : uint8_t * - Pointer to buffer which stores the ascii char
  * @param digits  : uint8_t   - integer value of no of ascii digits in buffer
  * @param base    : uint32_t  - target base
@@ -507,53 +523,11 @@ void test_itoa( int32_t data, uint8_t * ptr, uint32_t base){
  *--------------------------------------------------------------------------------------------*/
 
 int32_t my_atoi(uint8_t * ptr, uint8_t digits, uint32_t base){
-    //uint8_t * buff_start_addr = ptr;               // store buffer start address
-    int8_t FLAG_SIGN = 0;                          // 1:-VE ; 0:+VE
-    int32_t res_int = 0;
-
-    // check sign data for base 10;
-    if (*(ptr) == '-') FLAG_SIGN = 1;
 
+    int32_t res_int;
 
-    // update to the last pointer address containing integer ascii data
-    ptr = ptr + (digits-2); 
-    switch (base){
-
-        case 2:
-            //ptr = ptr + (digits-2); 		  // skip '0' and 'b'
-            digits -= 3;                          // exclude '\0', 'b' and  '0'
-            break;
-
-        case 8:
-            //ptr = ptr + (digits-2); 		  // skip '0' and 'c'
-            digits -= 3;                          // exclude '\0', 'c' and  '0'
-            break;
-
-        case 10:
-            if (FLAG_SIGN) {
-                digits -= 2;             	 // update address ascii integer & '-' in buffer;
-            }else{
-                digits -= 1;                     // update address only ascii integer in buffer   
-            }
-            break;
-
-        case 16:
-            //ptr = ptr + (digits-2); 		  // skip '0' and 'x'
-            digits -= 3;                          // exclude '\0', 'x' and  '0'
-            break;
-
-        default:
-            NULL;
-
-
-    }
-    // fetch ascii digit, convert to int, convert to base
-    for (int i=0; i<digits; i++){
-        res_int += (int32_t)ascii_2_int(*(ptr)) * my_pow(base, i);
-        ptr--;                                           // decrease pointer addr
-    }
-    if ((FLAG_SIGN==1) && (base==10)) res_int *= -1;     // update result if signed
-
+    (void)digits;                                      // end is found by the parser
+    my_atoi_parse(ptr, base, &res_int, NULL);
     return res_int;
 
 }
@@ -594,14 +568,6 @@ int main(){
     printf ("\n*** Base 16");
     test_itoa(data, ptr, 16);    // base 16
     test_atoi(ptr, 11, 16);       // base 16 +ve(digits:2); -ve(digits:8)
-    
-    // test the power function
-    printf ("\npower of 3^3: %d\n", my_pow(3, 3));
-
-
-    // test ascii to int
-    printf ("\nchar E: %d\n", ascii_2_int('E'));
-    printf ("\nchar 1: %d\n", ascii_2_int('1'));
 
 }
 
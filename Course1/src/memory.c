@@ -32,6 +32,35 @@
     #include "memory.h"
 #endif
 
+#include <assert.h>
+#include "cpu_dispatch.h"
+
+#if defined (CPU_DISPATCH_X86)
+    #include <immintrin.h>                  // SSE2 - AVX-512 kernels, see mem_bind
+#elif defined (MSP432)
+    #include "platform.h"                   // CMSIS intrinsics - __REV
+#endif
+
+
+/***********************************************************
+ Private word types
+ -> mem_word_t  : aligned 64-bit word store/load
+ -> mem_uword_t : 64-bit word load from any byte address
+ may_alias lets the word accesses overlay plain byte buffers
+***********************************************************/
+typedef uint64_t __attribute__((__may_alias__)) mem_word_t;
+typedef uint64_t __attribute__((__may_alias__, __aligned__(1))) mem_uword_t;
+
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) mem_uword32_t;
+
+#define MEM_WORD_SIZE   (sizeof(mem_word_t))
+#define MEM_WORD_MASK   (MEM_WORD_SIZE - 1)
+
+/* fills of at least this many bytes bypass the cache (HOST only) */
+#ifndef MEM_STREAM_THRESHOLD
+#define MEM_STREAM_THRESHOLD   (4UL*1024UL*1024UL)
+#endif
+
 /***********************************************************
  Function Definitions
 ***********************************************************/
@@ -59,47 +88,393 @@ void clear_all(char * ptr, unsigned int size){
 }
 
 
-/*----------------------------- my_memmove -----------------------------*
+/***********************************************************
+ Vector kernels
+ Each kernel handles the whole vectors of a copy / fill /
+ reverse and returns the bytes done; the caller finishes
+ with 64-bit words and single bytes. On x86 HOST mem_bind
+ picks the widest kernel the CPU supports (cpu_dispatch.h),
+ other platforms use the _none kernels (no vectors).
+***********************************************************/
+typedef size_t (*mem_copy_fn)(uint8_t * dst, const uint8_t * src, size_t length);
+typedef size_t (*mem_fill_fn)(uint8_t * dst, size_t length, uint64_t word);
+typedef size_t (*mem_reverse_fn)(uint8_t * lo, uint8_t * hi);
+
+static inline size_t mem_copy_fwd_none(uint8_t * dst, const uint8_t * src, size_t length){
+    (void)dst; (void)src; (void)length;
+    return 0;
+}
+
+static inline size_t mem_copy_bwd_none(uint8_t * dst, const uint8_t * src, size_t length){
+    (void)dst; (void)src; (void)length;
+    return 0;
+}
+
+static inline size_t mem_fill_none(uint8_t * dst, size_t length, uint64_t word){
+    (void)dst; (void)length; (void)word;
+    return 0;
+}
+
+static inline size_t mem_reverse_none(uint8_t * lo, uint8_t * hi){
+    (void)lo; (void)hi;
+    return 0;
+}
+
+
+
+#if defined (CPU_DISPATCH_X86)
+/*------------------- mem_copy_fwd_<isa> ---------------------------------------*
  *
- * This function takes two byte pointers (one source and one destination)
- * and a length of bytes to move from the source location to the 
- * destination.
- * it checks for overlap of source and destination by checking for 
- * contiguous available space to store data and avoid data corruption
- *----------------------------------------------------------------------*/
-uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length){
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * Copy whole vectors from the start addresses upwards (16 / 32 / 64 bytes per
+ * store for SSE2 / AVX2 / AVX-512), returns the bytes copied.
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static size_t mem_copy_fwd_sse2(uint8_t * dst, const uint8_t * src, size_t length){
+    size_t done = 0;
+    for (; (length - done) >= sizeof(__m128i); done += sizeof(__m128i)){
+        _mm_storeu_si128((__m128i *)(dst + done), _mm_loadu_si128((const __m128i *)(src + done)));
+    }
+    return done;
+}
 
-    // store a copy of start and last byte address for both src and dst
-    uint8_t * dst_start_ptr_addr = dst;                          // store dst start addr - copy
-    uint8_t * dst_last_ptr_addr = (uint8_t *)(dst + (length-1)); // store dst last byte addr- copy
+__attribute__((target("avx2")))
+static size_t mem_copy_fwd_avx2(uint8_t * dst, const uint8_t * src, size_t length){
+    size_t done = 0;
+    for (; (length - done) >= sizeof(__m256i); done += sizeof(__m256i)){
+        _mm256_storeu_si256((__m256i *)(dst + done), _mm256_loadu_si256((const __m256i *)(src + done)));
+    }
+    return done;
+}
 
-    uint8_t * src_start_ptr_addr = src;                          // store src byte addr- copy
-    uint8_t * src_last_ptr_addr = (uint8_t *)(src + (length-1)); // store src last byte addr- copy
-    
-    // Check for overlap by comparing the address location of src and dst
-    if (dst > src){ // move data from lower start (src) address  to higher start (dst) address
-        
-        // move data starting from last address upwards
-        for (int i=0; i<length; i++){
-            (*(dst_last_ptr_addr--)) = (*(src_last_ptr_addr));   // copy data
-            (*(src_last_ptr_addr)) = 0;                          // replace with zero after move
-            src_last_ptr_addr--;                                 // decrease adddress - next addr
+__attribute__((target("avx512f")))
+static size_t mem_copy_fwd_avx512(uint8_t * dst, const uint8_t * src, size_t length){
+    size_t done = 0;
+    for (; (length - done) >= sizeof(__m512i); done += sizeof(__m512i)){
+        _mm512_storeu_si512((void *)(dst + done), _mm512_loadu_si512((const void *)(src + done)));
+    }
+    return done;
+}
+
+
+
+/*------------------- mem_copy_bwd_<isa> ---------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * Copy whole vectors from the end addresses (dst / src point one past the last
+ * byte) downwards, returns the bytes copied.
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static size_t mem_copy_bwd_sse2(uint8_t * dst, const uint8_t * src, size_t length){
+    size_t done = 0;
+    while ((length - done) >= sizeof(__m128i)){
+        done += sizeof(__m128i);
+        _mm_storeu_si128((__m128i *)(dst - done), _mm_loadu_si128((const __m128i *)(src - done)));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t mem_copy_bwd_avx2(uint8_t * dst, const uint8_t * src, size_t length){
+    size_t done = 0;
+    while ((length - done) >= sizeof(__m256i)){
+        done += sizeof(__m256i);
+        _mm256_storeu_si256((__m256i *)(dst - done), _mm256_loadu_si256((const __m256i *)(src - done)));
+    }
+    return done;
+}
+
+__attribute__((target("avx512f")))
+static size_t mem_copy_bwd_avx512(uint8_t * dst, const uint8_t * src, size_t length){
+    size_t done = 0;
+    while ((length - done) >= sizeof(__m512i)){
+        done += sizeof(__m512i);
+        _mm512_storeu_si512((void *)(dst - done), _mm512_loadu_si512((const void *)(src - done)));
+    }
+    return done;
+}
+
+
+
+/*------------------- mem_fill_<isa> -------------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * Store the 8 byte word (already in pattern phase, dst is word aligned) as whole
+ * vectors, returns the bytes stored. Fills of MEM_STREAM_THRESHOLD bytes or
+ * more are aligned to the vector size with word stores and then streamed past
+ * the cache with non-temporal stores.
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static size_t mem_fill_sse2(uint8_t * dst, size_t length, uint64_t word){
+    __m128i vec = _mm_set1_epi64x((long long)word);
+    size_t done = 0;
+
+    if (length >= MEM_STREAM_THRESHOLD){
+        for (; ((uintptr_t)(dst + done) & (sizeof(__m128i) - 1)) != 0; done += MEM_WORD_SIZE){
+            *((mem_word_t *)(dst + done)) = word;
         }
-    
-    }else if (dst < src){ // move data from higher start (src) to lower start (dst) address
-    
-        // move data starting from start address downwards    
-        for (int i=0; i<length; i++){
-            (*(dst_start_ptr_addr++)) = (*(src_start_ptr_addr)); // copy data
-            (*(src_start_ptr_addr)) = 0;                         // replace with zero after move
-            src_start_ptr_addr++;                                // increase address - next    
+        for (; (length - done) >= sizeof(__m128i); done += sizeof(__m128i)){
+            _mm_stream_si128((__m128i *)(dst + done), vec);
         }
+        _mm_sfence();                                           // order streamed stores
+    }
+    for (; (length - done) >= sizeof(__m128i); done += sizeof(__m128i)){
+        _mm_storeu_si128((__m128i *)(dst + done), vec);
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t mem_fill_avx2(uint8_t * dst, size_t length, uint64_t word){
+    __m256i vec = _mm256_set1_epi64x((long long)word);
+    size_t done = 0;
+
+    if (length >= MEM_STREAM_THRESHOLD){
+        for (; ((uintptr_t)(dst + done) & (sizeof(__m256i) - 1)) != 0; done += MEM_WORD_SIZE){
+            *((mem_word_t *)(dst + done)) = word;
+        }
+        for (; (length - done) >= sizeof(__m256i); done += sizeof(__m256i)){
+            _mm256_stream_si256((__m256i *)(dst + done), vec);
+        }
+        _mm_sfence();                                           // order streamed stores
+    }
+    for (; (length - done) >= sizeof(__m256i); done += sizeof(__m256i)){
+        _mm256_storeu_si256((__m256i *)(dst + done), vec);
+    }
+    return done;
+}
+
+__attribute__((target("avx512f")))
+static size_t mem_fill_avx512(uint8_t * dst, size_t length, uint64_t word){
+    __m512i vec = _mm512_set1_epi64((long long)word);
+    size_t done = 0;
+
+    if (length >= MEM_STREAM_THRESHOLD){
+        for (; ((uintptr_t)(dst + done) & (sizeof(__m512i) - 1)) != 0; done += MEM_WORD_SIZE){
+            *((mem_word_t *)(dst + done)) = word;
+        }
+        for (; (length - done) >= sizeof(__m512i); done += sizeof(__m512i)){
+            _mm512_stream_si512((void *)(dst + done), vec);
+        }
+        _mm_sfence();                                           // order streamed stores
+    }
+    for (; (length - done) >= sizeof(__m512i); done += sizeof(__m512i)){
+        _mm512_storeu_si512((void *)(dst + done), vec);
+    }
+    return done;
+}
+
+
+
+/*------------------- mem_reverse_<isa> ----------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * Reverse blocks from both ends of [lo .. hi) while two whole blocks are left:
+ * a block is loaded from each end, byte reversed in a register and stored at
+ * the opposite end. Returns the bytes done at each end.
+ *   SSSE3   : 16 byte pshufb
+ *   AVX2    : 32 byte vpshufb inside each 128-bit lane, then the lanes swapped
+ *   AVX-512 : 64 byte vpshufb inside each 128-bit lane, then the 4 lanes reversed
+ * Each kernel finishes with the next smaller block.
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("ssse3")))
+static size_t mem_reverse_ssse3(uint8_t * lo, uint8_t * hi){
+    const __m128i rev_mask = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0);
+    size_t done = 0;
+
+    while ((size_t)(hi - lo) >= 2*(done + sizeof(__m128i))){
+        __m128i lo_vec, hi_vec;
+        done += sizeof(__m128i);
+        lo_vec = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(lo + done - sizeof(__m128i))), rev_mask);
+        hi_vec = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(hi - done)), rev_mask);
+        _mm_storeu_si128((__m128i *)(lo + done - sizeof(__m128i)), hi_vec);
+        _mm_storeu_si128((__m128i *)(hi - done), lo_vec);
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t mem_reverse_avx2(uint8_t * lo, uint8_t * hi){
+    const __m256i rev_mask = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                              7, 6, 5, 4, 3, 2, 1, 0,
+                                              15, 14, 13, 12, 11, 10, 9, 8,
+                                              7, 6, 5, 4, 3, 2, 1, 0);
+    size_t done = 0;
+
+    while ((size_t)(hi - lo) >= 2*(done + sizeof(__m256i))){
+        __m256i lo_vec, hi_vec;
+        done += sizeof(__m256i);
+        lo_vec = _mm256_loadu_si256((const __m256i *)(lo + done - sizeof(__m256i)));
+        hi_vec = _mm256_loadu_si256((const __m256i *)(hi - done));
+        // reverse bytes in each 128-bit lane then swap the lanes
+        lo_vec = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(lo_vec, rev_mask), 0x4E);
+        hi_vec = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(hi_vec, rev_mask), 0x4E);
+        _mm256_storeu_si256((__m256i *)(lo + done - sizeof(__m256i)), hi_vec);
+        _mm256_storeu_si256((__m256i *)(hi - done), lo_vec);
+    }
+    return done + mem_reverse_ssse3(lo + done, hi - done);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t mem_reverse_avx512(uint8_t * lo, uint8_t * hi){
+    const __m512i rev_mask = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                                                  7, 6, 5, 4, 3, 2, 1, 0));
+    const __m512i lane_order = _mm512_setr_epi64(6, 7, 4, 5, 2, 3, 0, 1);
+    size_t done = 0;
+
+    while ((size_t)(hi - lo) >= 2*(done + sizeof(__m512i))){
+        __m512i lo_vec, hi_vec;
+        done += sizeof(__m512i);
+        lo_vec = _mm512_loadu_si512((const void *)(lo + done - sizeof(__m512i)));
+        hi_vec = _mm512_loadu_si512((const void *)(hi - done));
+        // reverse bytes in each 128-bit lane then reverse the lane order
+        lo_vec = _mm512_permutexvar_epi64(lane_order, _mm512_shuffle_epi8(lo_vec, rev_mask));
+        hi_vec = _mm512_permutexvar_epi64(lane_order, _mm512_shuffle_epi8(hi_vec, rev_mask));
+        _mm512_storeu_si512((void *)(lo + done - sizeof(__m512i)), hi_vec);
+        _mm512_storeu_si512((void *)(hi - done), lo_vec);
+    }
+    return done + mem_reverse_avx2(lo + done, hi - done);
+}
+
+
+
+/* Kernels in use - mem_bind */
+static mem_copy_fn    mem_copy_fwd_kernel = mem_copy_fwd_none;
+static mem_copy_fn    mem_copy_bwd_kernel = mem_copy_bwd_none;
+static mem_fill_fn    mem_fill_kernel     = mem_fill_none;
+static mem_reverse_fn mem_reverse_kernel  = mem_reverse_none;
+
+#define MEM_KERNEL(name)  (name##_kernel)
+
+
+
+/*------------------- mem_bind -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Binds the vector kernels to an ISA level (cpu_dispatch_register)
+ *-------------------------------------------------------------------------------*/
+static void mem_bind(cpu_isa_t isa){
+    mem_copy_fwd_kernel = (isa >= CPU_ISA_AVX512) ? mem_copy_fwd_avx512 :
+                          (isa >= CPU_ISA_AVX2)   ? mem_copy_fwd_avx2   :
+                          (isa >= CPU_ISA_SSE2)   ? mem_copy_fwd_sse2   : mem_copy_fwd_none;
+    mem_copy_bwd_kernel = (isa >= CPU_ISA_AVX512) ? mem_copy_bwd_avx512 :
+                          (isa >= CPU_ISA_AVX2)   ? mem_copy_bwd_avx2   :
+                          (isa >= CPU_ISA_SSE2)   ? mem_copy_bwd_sse2   : mem_copy_bwd_none;
+    mem_fill_kernel     = (isa >= CPU_ISA_AVX512) ? mem_fill_avx512     :
+                          (isa >= CPU_ISA_AVX2)   ? mem_fill_avx2       :
+                          (isa >= CPU_ISA_SSE2)   ? mem_fill_sse2       : mem_fill_none;
+    mem_reverse_kernel  = (isa >= CPU_ISA_AVX512) ? mem_reverse_avx512  :
+                          (isa >= CPU_ISA_AVX2)   ? mem_reverse_avx2    :
+                          (isa >= CPU_ISA_SSSE3)  ? mem_reverse_ssse3   : mem_reverse_none;
+}
+
+__attribute__((constructor))
+static void mem_dispatch_init(void){
+    cpu_dispatch_register(mem_bind);                            // before main
+}
+#else
+#define MEM_KERNEL(name)  (name##_none)
+#endif
+
+
+
+/*------------------- mem_copy_fwd ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * This function copies data from the start address upwards.
+ * Safe for overlapping buffers as long as dst is below src.
+ *
+ *   head   : single bytes until dst is word aligned
+ *   middle : vectors (x86 HOST: SSE2 / AVX2 / AVX-512, see mem_bind)
+ *            then 64-bit words
+ *   tail   : remaining single bytes
+ *
+ * @param dst    : Pointer to destination start address
+ * @param src    : Pointer to source start address
+ * @param length : Number of bytes to copy
+ *
+ * @return       : void
+ *-------------------------------------------------------------------------------*/
+static void mem_copy_fwd(uint8_t * dst, const uint8_t * src, size_t length){
+
+    size_t done;
+
+    // head - copy bytes until destination is word aligned
+    while ((length != 0) && (((uintptr_t)dst & MEM_WORD_MASK) != 0)){
+        *(dst++) = *(src++);
+        length--;
+    }
+
+    done = MEM_KERNEL(mem_copy_fwd)(dst, src, length);         // vectors
+    dst += done; src += done; length -= done;
+
+    // middle - aligned 64-bit word stores
+    while (length >= MEM_WORD_SIZE){
+        *((mem_word_t *)dst) = *((const mem_uword_t *)src);
+        dst += MEM_WORD_SIZE; src += MEM_WORD_SIZE; length -= MEM_WORD_SIZE;
     }
-    return (dst);                                                // return destination start addr
 
+    // tail - remaining bytes
+    while (length != 0){
+        *(dst++) = *(src++);
+        length--;
+    }
 }
 
 
+
+/*------------------- mem_copy_bwd ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * This function copies data from the last address downwards.
+ * Safe for overlapping buffers as long as dst is above src.
+ * Same head / middle / tail split as mem_copy_fwd, walked from the end.
+ *
+ * @param dst    : Pointer to destination start address
+ * @param src    : Pointer to source start address
+ * @param length : Number of bytes to copy
+ *
+ * @return       : void
+ *-------------------------------------------------------------------------------*/
+static void mem_copy_bwd(uint8_t * dst, const uint8_t * src, size_t length){
+
+    size_t done;
+
+    dst += length;                                              // one past dst last byte
+    src += length;                                              // one past src last byte
+
+    // head - copy bytes until destination end is word aligned
+    while ((length != 0) && (((uintptr_t)dst & MEM_WORD_MASK) != 0)){
+        *(--dst) = *(--src);
+        length--;
+    }
+
+    done = MEM_KERNEL(mem_copy_bwd)(dst, src, length);         // vectors
+    dst -= done; src -= done; length -= done;
+
+    // middle - aligned 64-bit word stores
+    while (length >= MEM_WORD_SIZE){
+        dst -= MEM_WORD_SIZE; src -= MEM_WORD_SIZE; length -= MEM_WORD_SIZE;
+        *((mem_word_t *)dst) = *((const mem_uword_t *)src);
+    }
+
+    // tail - remaining bytes
+    while (length != 0){
+        *(--dst) = *(--src);
+        length--;
+    }
+}
+
+
+
 /*----------------------------- my_memcopy -----------------------------*
  *
  * This function takes two byte pointers (one source and one destination)
@@ -108,50 +483,148 @@ uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length){
  * 
  * it checks for overlap of source and destination by checking for 
  * contiguous available space to store data and avoid data corruption
+ *
+ * The copy is the same as my_memmove, so it is done by my_memmove.
  *----------------------------------------------------------------------*/
 uint8_t * my_memcopy(uint8_t * src, uint8_t * dst, size_t length){
 
-    // store a copy of start and last byte address for both src and dst
-    uint8_t * dst_start_ptr_addr = dst;                          // store dst start addr - copy
-    uint8_t * dst_last_ptr_addr = (uint8_t *)(dst + (length-1)); // store dst last byte addr- copy
+    return my_memmove(src, dst, length);                         // overlap safe block copy
+}
+
+
+/*----------------------------- my_memmove -----------------------------*
+ *
+ * This function takes two byte pointers (one source and one destination)
+ * and a length of bytes to move from the source location to the 
+ * destination.
+ * it checks for overlap of source and destination by checking for 
+ * contiguous available space to store data and avoid data corruption
+ *
+ * The source is left untouched, so the move runs as one block copy
+ * (forward or backward) - see my_memmove_clear for move and clear.
+ * Bulk of the data is copied a word (or vector on HOST) at a time,
+ * see mem_copy_fwd / mem_copy_bwd.
+ *----------------------------------------------------------------------*/
+uint8_t * my_memmove(uint8_t * src, uint8_t * dst, size_t length){
 
-    uint8_t * src_start_ptr_addr = src;                          // store src byte addr- copy
-    uint8_t * src_last_ptr_addr = (uint8_t *)(src + (length-1)); // store src last byte addr- copy
-    
     // Check for overlap by comparing the address location of src and dst
-    if (dst > src){ // copy data from lower start (src) address  to higher start (dst) address
+    if (dst > src){ // move data from lower start (src) address  to higher start (dst) address
+        mem_copy_bwd(dst, src, length);                          // move from last address upwards
 
-        // copy data starting from last address upwards
-        for (int i=0; i<length; i++){
-            (*(dst_last_ptr_addr--)) = (*(src_last_ptr_addr));   // copy data
-            src_last_ptr_addr--;                                 // decrease adddress - next addr
-        }
-    
     }else if (dst < src){ // move data from higher start (src) to lower start (dst) address
-    
-        // copy data starting from start address downwards    
-        for (int i=0; i<length; i++){
-            (*(dst_start_ptr_addr++)) = (*(src_start_ptr_addr)); // copy data
-            src_start_ptr_addr++;                                // increase address - next    
-        }
+        mem_copy_fwd(dst, src, length);                          // move from start address downwards
+    }
+    return (dst);                                                // return destination start addr
+
+}
+
+
+
+/*-------------------------- my_memmove_clear --------------------------*
+ *
+ * This function moves data like my_memmove and then zeroes the part
+ * of the source which was not overwritten by the destination.
+ *
+ *   dst above src : src [start .. dst start)   is cleared
+ *   dst below src : src (dst last .. src last] is cleared
+ *
+ * The cleared range is contiguous, so it is done in a single
+ * my_memzero pass after the move.
+ *----------------------------------------------------------------------*/
+uint8_t * my_memmove_clear(uint8_t * src, uint8_t * dst, size_t length){
+
+    uint8_t * src_end_ptr_addr = src + length;                   // one past src last byte
+    uint8_t * dst_end_ptr_addr = dst + length;                   // one past dst last byte
+
+    my_memmove(src, dst, length);
+
+    if (dst > src){ // clear src from its start up to the dst start (or src end)
+        my_memzero(src, (size_t)(((dst < src_end_ptr_addr) ? dst : src_end_ptr_addr) - src));
+
+    }else if (dst < src){ // clear src from the dst end (or src start) up to the src end
+        uint8_t * clear_ptr_addr = (dst_end_ptr_addr > src) ? dst_end_ptr_addr : src;
+        my_memzero(clear_ptr_addr, (size_t)(src_end_ptr_addr - clear_ptr_addr));
     }
     return (dst);                                                // return destination start addr
 }
 
 
+
+/*------------------- mem_fill -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * This function fills memory with a repeating 8 byte pattern so that
+ * dst[i] = pattern[i % 8]. 1, 2 and 4 byte patterns are passed in already
+ * repeated up to 8 bytes.
+ *
+ *   head   : single bytes until dst is word aligned
+ *   middle : pattern broadcast to a 64-bit word (and vectors on x86 HOST,
+ *            see mem_fill_<isa>) stored in aligned chunks. Fills of
+ *            MEM_STREAM_THRESHOLD bytes or more use non-temporal stores
+ *            which bypass the cache.
+ *   tail   : remaining single bytes
+ *
+ * @param dst     : Pointer to start address
+ * @param length  : Number of bytes to fill
+ * @param pattern : 8 byte pattern, pattern[0] is stored at dst[0]
+ *
+ * @return        : void
+ *-------------------------------------------------------------------------------*/
+static void mem_fill(uint8_t * dst, size_t length, const uint8_t * pattern){
+
+    uint8_t pattern_x2[2*MEM_WORD_SIZE];                        // pattern twice - any rotation
+    size_t phase = 0;                                           // pattern index of next byte
+    mem_word_t word;
+    size_t done;
+
+    // head - store bytes until destination is word aligned
+    while ((length != 0) && (((uintptr_t)dst & MEM_WORD_MASK) != 0)){
+        *(dst++) = pattern[phase++];
+        length--;
+    }
+
+    // broadcast the pattern, rotated to the current phase, into a word
+    for (size_t i=0; i<MEM_WORD_SIZE; i++){
+        pattern_x2[i] = pattern[i];
+        pattern_x2[i + MEM_WORD_SIZE] = pattern[i];
+    }
+    word = *((const mem_uword_t *)(pattern_x2 + phase));
+
+    done = MEM_KERNEL(mem_fill)(dst, length, (uint64_t)word);  // vectors
+    dst += done; length -= done;
+
+    // middle - aligned 64-bit word stores
+    while (length >= MEM_WORD_SIZE){
+        *((mem_word_t *)dst) = word;
+        dst += MEM_WORD_SIZE; length -= MEM_WORD_SIZE;
+    }
+
+    // tail - remaining bytes, still in pattern phase
+    while (length != 0){
+        *(dst++) = pattern_x2[phase++];
+        length--;
+    }
+}
+
+
+
 /*------------------------ my_memset -----------------------------*
  * 
  * This function takes a pointer to a source memory location, a length 
  * in bytes and set all locations of that memory to a given value.
-
+ *
+ * The value is broadcast to every byte of a word and stored in
+ * wide aligned chunks - see mem_fill.
  *----------------------------------------------------------------*/
 uint8_t * my_memset(uint8_t * src, size_t length, uint8_t value){
 
-    uint8_t * start_ptr_addr = src;                              // store start byte addr of data
-    for (int i=0; i<length; i++){
-        *(start_ptr_addr++) =value;                              // store value in addr &
-                                                                 // update pointer addr to next
+    uint8_t pattern[MEM_WORD_SIZE];                              // value in every byte
+
+    for (size_t i=0; i<MEM_WORD_SIZE; i++){
+        pattern[i] = value;
     }
+    mem_fill(src, length, pattern);
     return (src);                                                // return src start addr
 
 }
@@ -165,12 +638,90 @@ uint8_t * my_memset(uint8_t * src, size_t length, uint8_t value){
 -------------------------------------------------------------*/
 uint8_t * my_memzero(uint8_t * src, size_t length){
     
-    uint8_t * start_ptr_addr = src;                             // store last byte addr of data
+    return my_memset(src, length, 0);                           // return src start addr
+}
+
+
+
+/*---------------------- my_memset_pattern -----------------------*
+ *
+ * This function fills memory with a repeating 1, 2, 4 or 8 byte
+ * pattern. The first pattern byte is stored at the start address
+ * src[i] = pattern[i % pattern_len]
+ *----------------------------------------------------------------*/
+uint8_t * my_memset_pattern(uint8_t * src, size_t length,
+                            const uint8_t * pattern, size_t pattern_len){
+
+    uint8_t pattern_word[MEM_WORD_SIZE];                         // pattern repeated to a word
 
-    for (int i=0; i<length; i++){
-        *(start_ptr_addr++) =0;                                 // data at current src = 0 
+    if ((pattern_len == 0) || (pattern_len > MEM_WORD_SIZE) ||
+        ((MEM_WORD_SIZE % pattern_len) != 0)){
+        return NULL;                                             // unsupported pattern length
+    }
+
+    for (size_t i=0; i<MEM_WORD_SIZE; i++){
+        pattern_word[i] = pattern[i % pattern_len];
+    }
+    mem_fill(src, length, pattern_word);
+    return (src);                                                // return src start addr
+}
+
+
+
+/*------------------- mem_reverse ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * This function reverses the bytes between lo and hi. A block is loaded
+ * from each end, byte reversed in a register and stored at the opposite
+ * end, so both ends move inwards by one block per step:
+ *
+ *   HOST   : 64 / 32 / 16 byte shuffle (see mem_reverse_<isa>), then bswap64
+ *   MSP432 : 32-bit words with __REV
+ *
+ * Once less than two blocks are left, the next smaller block is used and
+ * the last few bytes are swapped one pair at a time.
+ *
+ * @param lo : Pointer to first byte
+ * @param hi : Pointer to one past the last byte
+ *
+ * @return   : void
+ *-------------------------------------------------------------------------------*/
+static void mem_reverse(uint8_t * lo, uint8_t * hi){
+
+    size_t done;
+
+    done = MEM_KERNEL(mem_reverse)(lo, hi);                    // vectors
+    lo += done; hi -= done;
+
+#if defined (MSP432)
+    while ((size_t)(hi - lo) >= 2*sizeof(uint32_t)){           // 4 bytes from each end
+        uint32_t lo_word, hi_word;
+        hi -= sizeof(uint32_t);
+        lo_word = __REV(*((const mem_uword32_t *)lo));
+        hi_word = __REV(*((const mem_uword32_t *)hi));
+        *((mem_uword32_t *)lo) = hi_word;
+        *((mem_uword32_t *)hi) = lo_word;
+        lo += sizeof(uint32_t);
+    }
+#else
+    while ((size_t)(hi - lo) >= 2*MEM_WORD_SIZE){              // 8 bytes from each end
+        uint64_t lo_word, hi_word;
+        hi -= MEM_WORD_SIZE;
+        lo_word = __builtin_bswap64(*((const mem_uword_t *)lo));
+        hi_word = __builtin_bswap64(*((const mem_uword_t *)hi));
+        *((mem_uword_t *)lo) = hi_word;
+        *((mem_uword_t *)hi) = lo_word;
+        lo += MEM_WORD_SIZE;
+    }
+#endif
+
+    // swap the remaining byte pairs - the middle byte of an odd count stays
+    while ((hi - lo) > 1){
+        uint8_t tempByte = *(--hi);
+        *hi = *lo;
+        *(lo++) = tempByte;
     }
-    return (src);                                               // return src start addr
 }
 
 
@@ -195,24 +746,347 @@ uint8_t * my_memzero(uint8_t * src, size_t length){
  * -> 0xF3 - 32.   |   |
  * -> 0xF4 - 40 <--+   |
  * -> 0xF5 - 25 <------+
+ *
+ * Swapping is done a block at a time from both ends,
+ * see mem_reverse.
  *------------------------------------------------------------*/
 uint8_t * my_reverse(uint8_t * src, size_t length){
 
-    uint8_t * start_ptr_addr = src;                           // store start addr temporarily
-    uint8_t * last_ptr_addr = (uint8_t *)(src + (length-1));  // store last byte addr of data
-    uint8_t tempByte;                                         // Variable to store data from ptr addr
+    mem_reverse(src, src + length);       // reverse [start addr .. last addr]
+    return src;                           // return src start addr
+}
+
+
+
+/***********************************************************
+ Arena allocator
+***********************************************************/
+static mem_arena_t * current_arena = NULL;     // arena used by reserve_words
+static size_t current_arena_live = 0;          // its reserve_words blocks not yet freed
+
+// last arena uninstalled with live blocks - free_words still knows its range
+static uint8_t * retired_arena_base = NULL;
+static uint8_t * retired_arena_end  = NULL;
+static size_t retired_arena_live = 0;          // 0: no retired arena
+
+
+
+/*------------------- arena_init -------------------------*
+ *
+ * This function sets up an arena on a caller supplied
+ * buffer. The buffer start is rounded up to the arena
+ * alignment, so some bytes at the front may be unused.
+ *--------------------------------------------------------*/
+mem_arena_t * arena_init(mem_arena_t * arena, uint8_t * buffer, size_t size){
+
+    size_t pad;                                         // bytes skipped to align start
+
+    if ((arena == NULL) || (buffer == NULL)) return NULL;
+
+    pad = (size_t)(-(uintptr_t)buffer & (MEM_ARENA_ALIGN - 1));
+    if (pad > size) pad = size;
+
+    arena->base   = buffer + pad;
+    arena->size   = size - pad;
+    arena->offset = 0;
+    arena->heap   = NULL;
+    return arena;
+}
+
+
+
+/*------------------- arena_create -----------------------*
+ *
+ * This function sets up an arena on a single malloc
+ * block. Use arena_destroy to release the block.
+ *--------------------------------------------------------*/
+mem_arena_t * arena_create(mem_arena_t * arena, size_t size){
+
+    uint8_t * block;
 
-    /* start reverse data by swapping */
-    while (src <= last_ptr_addr){	      // As long as start addr is not equal to last addr
-        tempByte = *(src);                // Store byte data temporarily 
-        *(src) = *(last_ptr_addr);        // Place data from last addr to first (start) addr
-        *(last_ptr_addr) = tempByte;      // Move data stored in temp var from start addr to last addr
-        src++;                            // Update start addr -> address increases
-        last_ptr_addr--;                  // Update last  addr -> address decreases
+    if (arena == NULL) return NULL;
 
-        
+    block = (uint8_t *)malloc(size + MEM_ARENA_ALIGN);  // room to align the start
+    if (block == NULL) return NULL;
+
+    arena_init(arena, block, size + MEM_ARENA_ALIGN);
+    arena->size = size;
+    arena->heap = block;                                // remember block for free
+    return arena;
+}
+
+
+
+/*------------------- arena_destroy ----------------------*
+ *
+ * This function releases the malloc block of an arena
+ * made by arena_create and uninstalls the arena if it is
+ * the current one.
+ *--------------------------------------------------------*/
+void arena_destroy(mem_arena_t * arena){
+
+    if (arena == NULL) return;
+    arena_reset(arena);                                 // forget its live blocks
+    if (current_arena == arena) current_arena = NULL;
+
+    free((void *)arena->heap);                          // NULL for caller buffers - no-op
+    arena->base   = NULL;
+    arena->size   = 0;
+    arena->offset = 0;
+    arena->heap   = NULL;
+}
+
+
+
+/*------------------- arena_reserve_words ----------------*
+ *
+ * This function bump allocates a block of words from
+ * the arena. Blocks start on a MEM_ARENA_ALIGN boundary.
+ *--------------------------------------------------------*/
+int32_t * arena_reserve_words(mem_arena_t * arena, size_t length){
+
+    size_t offset;                                      // aligned start of the new block
+    size_t bytes;
+
+    if ((arena == NULL) || (length > (SIZE_MAX / sizeof(int32_t)))) return NULL;
+
+    bytes  = length * sizeof(int32_t);
+    offset = (arena->offset + (MEM_ARENA_ALIGN - 1)) & ~(size_t)(MEM_ARENA_ALIGN - 1);
+    if ((offset > arena->size) || (bytes > (arena->size - offset))) return NULL;  // arena full
+
+    arena->offset = offset + bytes;
+    return (int32_t *)(arena->base + offset);
+}
+
+
+
+/*------------------- arena_reset ------------------------*
+ *
+ * This function releases every block of the arena at
+ * once by rewinding the bump offset. Live reserve_words
+ * blocks of the arena are released with it.
+ *--------------------------------------------------------*/
+void arena_reset(mem_arena_t * arena){
+
+    if (arena == NULL) return;
+    arena->offset = 0;
+    if (arena == current_arena) current_arena_live = 0;
+    if (arena->base == retired_arena_base) retired_arena_live = 0;
+}
+
+
+
+/*------------------- arena_install ----------------------*
+ *
+ * This function makes the arena the source of memory for
+ * reserve_words. Pass NULL to go back to malloc.
+ *
+ * An arena uninstalled while blocks reserve_words took
+ * from it are live is retired: free_words keeps leaving
+ * its blocks alone until they are freed or the arena is
+ * reset. Only one arena can be retired at a time.
+ *--------------------------------------------------------*/
+mem_arena_t * arena_install(mem_arena_t * arena){
+
+    mem_arena_t * previous = current_arena;
+    size_t live = 0;
+
+    if (arena == current_arena) return previous;
+
+    if ((arena != NULL) && (retired_arena_live != 0) && (arena->base == retired_arena_base)){
+        live = retired_arena_live;                      // retired arena back in use
+        retired_arena_live = 0;
+    }
+    if (current_arena_live != 0){
+        assert(retired_arena_live == 0);                // live blocks of two old arenas
+        retired_arena_base = current_arena->base;
+        retired_arena_end  = current_arena->base + current_arena->size;
+        retired_arena_live = current_arena_live;
+    }
+
+    current_arena = arena;
+    current_arena_live = live;
+    return previous;                                    // caller can restore it later
+}
+
+
+
+/***********************************************************
+ Fixed size block pools
+***********************************************************/
+static mem_pool_t * current_pools = NULL;      // size classes, smallest block first
+static size_t current_pool_count = 0;
+static size_t current_pool_live = 0;           // their reserve_words blocks not yet freed
+
+// last pools uninstalled with live blocks - free_words still gives blocks back
+static mem_pool_t * retired_pools = NULL;
+static size_t retired_pool_count = 0;
+static size_t retired_pool_live = 0;           // 0: no retired pools
+
+
+
+/*------------------- pool_init --------------------------*
+ *
+ * This function sets up a pool of block_count blocks of
+ * block_words words each on caller supplied storage and
+ * links every block into the free list. The in use
+ * bitmap follows the last block and starts cleared.
+ *--------------------------------------------------------*/
+mem_pool_t * pool_init(mem_pool_t * pool, uint8_t * storage, size_t storage_size,
+                       size_t block_words, size_t block_count){
+
+    size_t block_bytes = MEM_POOL_BLOCK_BYTES(block_words);
+    mem_pool_block_t ** link;
+
+    if ((pool == NULL) || (storage == NULL) || (block_words == 0) ||
+        (((uintptr_t)storage & (MEM_ARENA_ALIGN - 1)) != 0) ||
+        (block_count > (storage_size / block_bytes)) ||
+        ((storage_size - (block_count * block_bytes)) < MEM_POOL_MAP_BYTES(block_count))){
+        return NULL;                                    // storage missing, unaligned or too small
+    }
+
+    pool->storage     = storage;
+    pool->block_words = block_words;
+    pool->block_bytes = block_bytes;
+    pool->block_count = block_count;
+    pool->in_use_map  = storage + (block_count * block_bytes);
+    pool->in_use      = 0;
+    pool->high_water  = 0;
+    my_memzero(pool->in_use_map, MEM_POOL_MAP_BYTES(block_count));
+
+    // thread the free list through the blocks in address order
+    link = &pool->free_list;
+    for (size_t i=0; i<block_count; i++){
+        *link = (mem_pool_block_t *)(storage + (i * block_bytes));
+        link  = &((*link)->next);
+    }
+    *link = NULL;
+    return pool;
+}
+
+
+
+/*------------------- pool_reserve -----------------------*
+ *
+ * This function pops a block from the pool free list and
+ * marks it in use.
+ *--------------------------------------------------------*/
+int32_t * pool_reserve(mem_pool_t * pool){
+
+    mem_pool_block_t * block;
+    size_t index;
+
+    if ((pool == NULL) || (pool->free_list == NULL)) return NULL;
+
+    block = pool->free_list;
+    pool->free_list = block->next;
+    index = (size_t)((uint8_t *)block - pool->storage) / pool->block_bytes;
+    pool->in_use_map[index >> 3] |= (uint8_t)(1U << (index & 7));
+    pool->in_use++;
+    if (pool->in_use > pool->high_water) pool->high_water = pool->in_use;
+    return (int32_t *)block;
+}
+
+
+
+/*------------------- pool_owns --------------------------*
+ *
+ * This function checks if a pointer lies in the pool
+ * storage.
+ *--------------------------------------------------------*/
+uint8_t pool_owns(const mem_pool_t * pool, const void * src){
+
+    const uint8_t * ptr = (const uint8_t *)src;
+
+    return (uint8_t)((pool != NULL) && (ptr >= pool->storage) &&
+                     (ptr < pool->storage + (pool->block_count * pool->block_bytes)));
+}
+
+
+
+/*------------------- pool_release -----------------------*
+ *
+ * This function pushes a block back on the pool free
+ * list. Pointers which are not the start of a block of
+ * the pool, releases with no block in use and blocks
+ * whose in use bit is clear (double free) are refused.
+ *--------------------------------------------------------*/
+uint8_t pool_release(mem_pool_t * pool, void * src){
+
+    mem_pool_block_t * block = (mem_pool_block_t *)src;
+    size_t offset;
+    uint8_t mask;
+
+    if ((pool == NULL) || (block == NULL) || (pool->in_use == 0) || !pool_owns(pool, src)){
+        return 0;                                       // not a block in use of this pool
     }
-    return start_ptr_addr;                // return src start addr
+    offset = (size_t)((uint8_t *)src - pool->storage);
+    if ((offset % pool->block_bytes) != 0) return 0;    // inside a block
+    offset /= pool->block_bytes;
+    mask = (uint8_t)(1U << (offset & 7));
+    if ((pool->in_use_map[offset >> 3] & mask) == 0) return 0;   // double free
+    pool->in_use_map[offset >> 3] &= (uint8_t)~mask;
+
+    block->next = pool->free_list;
+    pool->free_list = block;
+    pool->in_use--;
+    return 1;
+}
+
+
+
+/*------------------- pool_install -----------------------*
+ *
+ * This function makes reserve_words serve requests from
+ * the pools (size classes). Pass NULL / 0 to remove.
+ *
+ * Pools uninstalled while blocks reserve_words took from
+ * them are live are retired, as arenas are (see
+ * arena_install): free_words still gives their blocks
+ * back. Only one set of pools can be retired at a time.
+ *--------------------------------------------------------*/
+void pool_install(mem_pool_t * pools, size_t pool_count){
+
+    size_t live = 0;
+
+    if (pool_count == 0) pools = NULL;
+    if (pools == NULL) pool_count = 0;
+    if ((pools == current_pools) && (pool_count == current_pool_count)) return;
+
+    if ((pools != NULL) && (retired_pool_live != 0) && (pools == retired_pools)){
+        live = retired_pool_live;                       // retired pools back in use
+        retired_pool_live = 0;
+    }
+    if (current_pool_live != 0){
+        assert(retired_pool_live == 0);                 // live blocks of two old pool sets
+        retired_pools      = current_pools;
+        retired_pool_count = current_pool_count;
+        retired_pool_live  = current_pool_live;
+    }
+
+    current_pools = pools;
+    current_pool_count = pool_count;
+    current_pool_live = live;
+}
+
+
+
+/*------------------- pool_free_words --------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Gives src back to the pool of the array which owns it
+ * and counts it off live. Returns 0 if no pool owns src.
+ *--------------------------------------------------------*/
+static uint8_t pool_free_words(mem_pool_t * pools, size_t pool_count, void * src, size_t * live){
+
+    for (size_t i=0; i<pool_count; i++){
+        if (pool_owns(&pools[i], src)){
+            if (pool_release(&pools[i], src) && (*live != 0)) (*live)--;
+            return 1;
+        }
+    }
+    return 0;
 }
 
 
@@ -222,10 +1096,29 @@ uint8_t * my_reverse(uint8_t * src, size_t length){
  * This should take number of words to allocate in 
  * dynamic memory by using the malloc function and
  * casting to ptr to the data type
+ *
+ * When pools are installed the first size class
+ * with big enough blocks and a free block is used.
+ * Otherwise, when an arena is installed the words
+ * come from the arena instead of the heap.
  *-------------------------------------------------*/
 int32_t * reserve_words(size_t length){
 
-    int32_t * word_ptr = (int32_t *)malloc(length*sizeof(int32_t)); // reserve memory space on the heap
+    int32_t * word_ptr;
+
+    for (size_t i=0; i<current_pool_count; i++){
+        if ((length <= current_pools[i].block_words) &&
+            (current_pools[i].free_list != NULL)){
+            current_pool_live++;
+            return pool_reserve(&current_pools[i]);       // O(1) pop from size class
+        }
+    }
+    if (current_arena != NULL){
+        word_ptr = arena_reserve_words(current_arena, length);  // bump allocate from arena
+        if (word_ptr != NULL) current_arena_live++;
+        return word_ptr;
+    }
+    word_ptr = (int32_t *)malloc(length*sizeof(int32_t)); // reserve memory space on the heap
 
     return word_ptr;
 
@@ -238,15 +1131,30 @@ int32_t * reserve_words(size_t length){
  * This function Should free a dynamic
  * memory allocation by providing the 
  * pointer src to the function
+ *
+ * Pool blocks go back to the pool they
+ * came from. Words from the installed
+ * arena are left alone - see arena_reset.
+ * The same holds for the retired arena
+ * and pools - see arena_install.
  *------------------------------------*/
 void free_words(uint32_t * src){
 
+    if (pool_free_words(current_pools, current_pool_count, src, &current_pool_live) ||
+        ((retired_pool_live != 0) &&
+         pool_free_words(retired_pools, retired_pool_count, src, &retired_pool_live))){
+        return;                        // back on the size class free list
+    }
+    if ((current_arena != NULL) &&
+        ((uint8_t *)src >= current_arena->base) &&
+        ((uint8_t *)src <  current_arena->base + current_arena->size)){
+        if (current_arena_live != 0) current_arena_live--;
+        return;                        // arena block - released by arena_reset
+    }
+    if ((retired_arena_live != 0) &&
+        ((uint8_t *)src >= retired_arena_base) && ((uint8_t *)src < retired_arena_end)){
+        retired_arena_live--;
+        return;                        // block of an uninstalled arena
+    }
     free((void *)src);                 // make occupied memory on heap available for use
 }
-
-
-
-
-
-
-
@@ -24,7 +24,17 @@
 
 #include <stdio.h>
 #include "stats.h"
+#include "stats_generic.h"
+#include "memory.h"
+#include "data.h"
 #include "platform.h"
+#include "cpu_dispatch.h"
+#include "trace.h"
+
+#if defined (CPU_DISPATCH_X86)
+    #define STATS_X86_KERNELS              // SSE2 / AVX2 / AVX-512 kernels picked at run time
+    #include <immintrin.h>
+#endif
 /* Size of the Data Set */
 #define SIZE (40)
 
@@ -47,79 +57,747 @@ void main() {
 
 /* Add other Implementation File Code Here */
 void print_statistics(unsigned char *dataSet, unsigned long data_length){
-    printf("\n*** DATA ARRAY STATISTICAL ANALYSIS ***\n\n");
-    printf("\nData array of size %u\n", (unsigned int)data_length);
-    print_array(dataSet, data_length);
-    printf("\nMedian = %u\n", (unsigned int)find_median(dataSet, data_length));
-    printf("\nMean   = %u\n", (unsigned int)find_mean(dataSet, data_length));
-    printf("\nMax    = %u\n", (unsigned int)find_maximum(dataSet, data_length));
-    printf("\nMin    = %u\n", (unsigned int)find_minimum(dataSet, data_length));
+    stats_result_t result;
+
+    compute_statistics(dataSet, data_length, &result);    // one pass, data unchanged
+    print_statistics_result(dataSet, data_length, &result);
 }
 
 
 
+/* Output buffer of the print functions, lives on the caller's stack */
+typedef struct {
+    char   text[STATS_PRINT_BUFFER_SIZE];
+    size_t length;
+} stats_out_t;
 
-void print_array(unsigned char *dataSet, unsigned long data_length){
+static const stats_print_options_t *print_options;           // NULL - print every item
+
+
+
+/*------------------- out_stdout -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Default writer - one fwrite to stdout.
+ *-------------------------------------------------------------------------------*/
+static void out_stdout(const char *text, size_t length){
+    fwrite(text, 1, length, stdout);
+}
+static stats_writer_t out_writer = out_stdout;
+
+
+
+/*------------------- out_flush --------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Hands the buffered text to the writer and empties the buffer. Waiting
+ * trace records are decoded first, so stdout keeps the order of the calls.
+ *-------------------------------------------------------------------------------*/
+static void out_flush(stats_out_t *out){
+    trace_flush();
+    if (out->length != 0) out_writer(out->text, out->length);
+    out->length = 0;
+}
+
+
+
+/*------------------- out_text ---------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Appends a '\0' terminated text, flushing whenever the buffer is full.
+ *-------------------------------------------------------------------------------*/
+static void out_text(stats_out_t *out, const char *text){
+    while (*text != '\0'){
+        if (out->length == STATS_PRINT_BUFFER_SIZE) out_flush(out);
+        out->text[out->length++] = *text++;
+    }
+}
+
+
+
+/*------------------- out_number -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Appends value in decimal (my_itoa), padded with spaces on the right to
+ * width characters (printf "%-<width>lu").
+ *-------------------------------------------------------------------------------*/
+static void out_number(stats_out_t *out, unsigned long value, unsigned int width){
+    uint8_t digits[24];
+    unsigned int length;
+
+    if (value <= 0x7FFFFFFFUL){
+        length = my_itoa((int32_t)value, digits, 10) - 1;         // without '\0'
+    }else{                                                        // beyond int32_t
+        uint8_t *end = digits + sizeof(digits);
+        length = 0;
+        do {
+            *--end = (uint8_t)('0' + (value % 10));
+            value /= 10;
+            length++;
+        } while (value != 0);
+        my_memmove(end, digits, length);
+    }
+    digits[length] = '\0';
+    out_text(out, (const char *)digits);
+    for (;length<width;length++) out_text(out, " ");
+}
+
+
+
+#if defined (VERBOSE) && defined (HOST)
+/*------------------- out_array --------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Renders the data array as chosen by the installed print options.
+ *-------------------------------------------------------------------------------*/
+static void out_array(stats_out_t *out, const unsigned char *dataSet, unsigned long data_length){
+    stats_print_options_t options = { STATS_PRINT_ALL, STATS_PRINT_COLUMNS, 0 };
+    unsigned long stride = 1;                                     // print every stride-th item
+    unsigned long i, column = 0;
+
+    if (print_options != NULL) options = *print_options;
+    if (options.columns == 0) options.columns = STATS_PRINT_COLUMNS;
+
+    out_text(out, "\n\nData array: ");
+    if ((options.mode == STATS_PRINT_SUMMARY) ||
+        ((options.mode == STATS_PRINT_SAMPLED) && (options.sample_count == 0))){
+        out_number(out, data_length, 0);
+        out_text(out, " items\n");
+        return;
+    }
+    if ((options.mode == STATS_PRINT_SAMPLED) && (data_length > options.sample_count)){
+        stride = (data_length + options.sample_count - 1) / options.sample_count;
+        out_text(out, "every ");
+        out_number(out, stride, 0);
+        out_text(out, ". of ");
+        out_number(out, data_length, 0);
+        out_text(out, " items");
+    }
+
+    for (i=0;i<data_length;i+=stride){
+        if (column == 0) out_text(out, "\n\t");                 // new row
+        out_number(out, dataSet[i], 3);
+        out_text(out, " ");
+        if (++column == options.columns) column = 0;
+    }
+    out_text(out, "\n");
+}
+#endif
+
+
+
+const stats_print_options_t *stats_print_install(const stats_print_options_t *options){
+    const stats_print_options_t *previous = print_options;
+
+    print_options = options;
+    return previous;
+}
+
+
+
+stats_writer_t stats_writer_install(stats_writer_t writer){
+    stats_writer_t previous = out_writer;
+
+    out_writer = (writer != NULL) ? writer : out_stdout;
+    return previous;
+}
+
+
+
+void print_statistics_result(unsigned char *dataSet, unsigned long data_length,
+                             const stats_result_t *result){
+    stats_out_t out;
+
+    out.length = 0;
+    out_text(&out, "\n*** DATA ARRAY STATISTICAL ANALYSIS ***\n\n");
+    out_text(&out, "\nData array of size ");
+    out_number(&out, data_length, 0);
+    out_text(&out, "\n");
+#if defined (VERBOSE) && defined (HOST)
+    out_array(&out, dataSet, data_length);
+#else
+    (void)dataSet;                                            // data items only printed in VERBOSE builds
+#endif
+    out_text(&out, "\nMedian = ");
+    out_number(&out, result->median, 0);
+    out_text(&out, "\n\nMean   = ");
+    out_number(&out, result->mean, 0);
+    out_text(&out, "\n\nMax    = ");
+    out_number(&out, result->maximum, 0);
+    out_text(&out, "\n\nMin    = ");
+    out_number(&out, result->minimum, 0);
+    out_text(&out, "\n");
+    out_flush(&out);
+}
+
+
+
+/*------------------- histogram_variance -----------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Population variance of the data counted in result->histogram, with
+ * result->count and result->sum already set. Deviations are taken from the
+ * exact mean sum / count, so there is no cancellation.
+ *-------------------------------------------------------------------------------*/
+static double histogram_variance(const stats_result_t *result){
+    double mean = (double)result->sum / (double)result->count;
+    double m2 = 0.0;
+    int value;
+
+    for (value=result->minimum;value<=result->maximum;value++){
+        double delta = (double)value - mean;
+        m2 += delta * delta * (double)result->histogram[value];
+    }
+    return m2 / (double)result->count;
+}
+
+
+
+void compute_statistics(const unsigned char *dataSet, unsigned long data_length,
+                        stats_result_t *result){
+    unsigned long i;
+    unsigned char minimum = 0xFF;
+    unsigned char maximum = 0x00;
+    unsigned long long dataSum = 0;
+
+    my_memzero((uint8_t *)result->histogram, sizeof(result->histogram));
+
+    // single streaming pass - min, max, sum and histogram together
+    for (i=0;i<data_length;i++){
+        unsigned char item = dataSet[i];
+        if (item < minimum) minimum = item;
+        if (item > maximum) maximum = item;
+        dataSum += item;
+        result->histogram[item]++;
+    }
+
+    result->count   = data_length;
+    result->sum     = dataSum;
+    if (data_length == 0){                                 // nothing to report
+        result->minimum = 0;
+        result->maximum = 0;
+        result->mean    = 0;
+        result->median  = 0;
+        result->variance = 0.0;
+        return;
+    }
+    result->minimum = minimum;
+    result->maximum = maximum;
+    result->mean    = (unsigned long)(dataSum / data_length);
+
+    // median - middle item (odd) or mean of the two middle items (even)
+    result->median  = (unsigned char)(((unsigned int)stats_value_at_rank(result, (data_length-1)/2) +
+                                       (unsigned int)stats_value_at_rank(result, data_length/2)) / 2);
+    result->variance = histogram_variance(result);
+}
+
+
+
+void stats_init(stats_acc_t *acc){
+    acc->count   = 0;
+    acc->sum     = 0;
+    acc->minimum = 0xFF;                                   // any item is smaller
+    acc->maximum = 0x00;                                   // any item is larger
+    acc->mean    = 0.0;
+    acc->m2      = 0.0;
+    my_memzero((uint8_t *)acc->histogram, sizeof(acc->histogram));
+}
+
+
+
+void stats_push(stats_acc_t *acc, unsigned char item){
+    double delta = (double)item - acc->mean;
+
+    acc->count++;
+    acc->sum += item;
+    if (item < acc->minimum) acc->minimum = item;
+    if (item > acc->maximum) acc->maximum = item;
+    acc->histogram[item]++;
+
+    // Welford update
+    acc->mean += delta / (double)acc->count;
+    acc->m2   += delta * ((double)item - acc->mean);
+}
+
+
+
+/*------------------- acc_combine ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Folds the mean and m2 of a part with part_count items into the accumulator
+ * (Chan et al. parallel variance). acc->count must not include the part yet.
+ *-------------------------------------------------------------------------------*/
+static void acc_combine(stats_acc_t *acc, unsigned long part_count,
+                        double part_mean, double part_m2){
+    double total = (double)acc->count + (double)part_count;
+    double delta = part_mean - acc->mean;
+
+    if (part_count == 0) return;
+    acc->mean += delta * ((double)part_count / total);
+    acc->m2   += part_m2 + (delta * delta * (((double)acc->count * (double)part_count) / total));
+}
+
+
+
+void stats_push_block(stats_acc_t *acc, const unsigned char *dataSet, unsigned long data_length){
+    while (data_length > 0){
+        unsigned long n = (data_length < STATS_BLOCK_LENGTH) ? data_length : STATS_BLOCK_LENGTH;
+        unsigned long long sum = 0;                        // <= 255 * 4096, exact
+        unsigned long long squares = 0;                    // <= 255^2 * 4096, exact
+        unsigned char minimum = acc->minimum;
+        unsigned char maximum = acc->maximum;
+        unsigned long i;
+
+        for (i=0;i<n;i++){
+            unsigned int item = dataSet[i];
+            if (item < minimum) minimum = (unsigned char)item;
+            if (item > maximum) maximum = (unsigned char)item;
+            sum     += item;
+            squares += item * item;
+            acc->histogram[item]++;
+        }
+
+        // chunk m2 = (n * squares - sum^2) / n, numerator exact in 64 bits
+        acc_combine(acc, n, (double)sum / (double)n,
+                    (double)((n * squares) - (sum * sum)) / (double)n);
+        acc->count  += n;
+        acc->sum    += sum;
+        acc->minimum = minimum;
+        acc->maximum = maximum;
+
+        dataSet     += n;
+        data_length -= n;
+    }
+}
+
+
+
+void stats_merge(stats_acc_t *acc, const stats_acc_t *other){
+    int value;
+
+    acc_combine(acc, other->count, other->mean, other->m2);
+    acc->count += other->count;
+    acc->sum   += other->sum;
+    if (other->minimum < acc->minimum) acc->minimum = other->minimum;
+    if (other->maximum > acc->maximum) acc->maximum = other->maximum;
+    for (value=0;value<STATS_BUCKETS;value++){
+        acc->histogram[value] += other->histogram[value];
+    }
+}
+
+
+
+void stats_snapshot(const stats_acc_t *acc, stats_result_t *result){
+    unsigned long n = acc->count;
+
+    my_memcopy((uint8_t *)acc->histogram, (uint8_t *)result->histogram, sizeof(result->histogram));
+    result->count = n;
+    result->sum   = acc->sum;
+    if (n == 0){                                           // nothing to report
+        result->minimum  = 0;
+        result->maximum  = 0;
+        result->mean     = 0;
+        result->median   = 0;
+        result->variance = 0.0;
+        return;
+    }
+    result->minimum  = acc->minimum;
+    result->maximum  = acc->maximum;
+    result->mean     = (unsigned long)(acc->sum / n);
+    result->median   = (unsigned char)(((unsigned int)stats_value_at_rank(result, (n-1)/2) +
+                                        (unsigned int)stats_value_at_rank(result, n/2)) / 2);
+    result->variance = acc->m2 / (double)n;
+}
+
+
+
+unsigned char stats_value_at_rank(const stats_result_t *result, unsigned long rank){
+    unsigned long seen = 0;                                // items in buckets below value
+    int value;
 
-#if defined (VERBOSE)
-    unsigned long i = 0;                                // data array indexer
-    //sort_array(dataSet, data_length);                   // sort the data array         
-    PRINTF("\n\nData array: ");                         // start printing on new line
+    if (rank >= result->count) return result->maximum;
 
-    while(i < data_length){
-        if ((i%10) == 0) PRINTF("\n\t");                // only print 10 numbers in a row - newline
-        PRINTF("%-3u ", (unsigned int)(*(dataSet++)));  // print data array item
-        i++;                                            // increase array index
+    // walk the histogram from the smallest value until rank is covered
+    for (value=result->minimum;value<result->maximum;value++){
+        seen += result->histogram[value];
+        if (seen > rank) break;
     }
-    PRINTF("\n");
+    return (unsigned char)value;
+}
+
+
+
+unsigned char stats_percentile(const stats_result_t *result, unsigned int percent){
+    unsigned long long rank;                               // nearest rank, 1 based
+
+    if (result->count == 0) return 0;
+    if (percent > 100) percent = 100;
+
+    rank = (((unsigned long long)result->count * percent) + 99) / 100;
+    if (rank == 0) rank = 1;                               // 0th percentile - minimum
+    return stats_value_at_rank(result, (unsigned long)(rank - 1));
+}
+
+
+
+
+void print_array(unsigned char *dataSet, unsigned long data_length){
+
+#if defined (VERBOSE) && defined (HOST)
+    stats_out_t out;                                    // no PRINTF on other platforms
+
+    out.length = 0;
+    out_array(&out, dataSet, data_length);
+    out_flush(&out);
+#else
+    (void)dataSet;
+    (void)data_length;
 #endif
 }
 
 
 
 unsigned char find_median(unsigned char *dataSet, unsigned long data_length){
-    unsigned long dataSum = 0;
+    unsigned long histogram[STATS_BUCKETS];
+    unsigned long lower = (data_length - 1) / 2;                  // the two middle ranks
+    unsigned long upper = data_length / 2;                        // (the same for an odd count)
+    unsigned long seen = 0;                                       // items below value + 1
+    unsigned long i;
+    int lower_value = -1;
+    int value;
 
     if (data_length ==  0) return 0;                              // check that data length is not zero
-    sort_array(dataSet, data_length);                             // Sort the dataset from largest to smallest
-    
-    if (data_length%2 == 1){                                      // Data length is odd
-        return dataSet[(data_length/2)+1];                        // return data item in middle position
 
-    }else{                                                        // Data length is even
-        /* return mean of 2 data items in middle position*/
-        dataSum = (unsigned long)(dataSet[(data_length/2)]) +     
-                  (unsigned long)(dataSet[(data_length/2)+1]);
-        
-        return (unsigned char) dataSum/2;                         // return mean of data 2 items in mid position
-        
+    // histogram median - O(n + 256), the data set is not sorted or modified;
+    // only the histogram is built (no min / max / sum / variance)
+    my_memzero((uint8_t *)histogram, sizeof(histogram));
+    for (i=0;i<data_length;i++){
+        histogram[dataSet[i]]++;
     }
+    for (value=0;value<(STATS_BUCKETS-1);value++){
+        seen += histogram[value];
+        if ((lower_value < 0) && (seen > lower)) lower_value = value;
+        if (seen > upper) break;
+    }
+    if (lower_value < 0) lower_value = value;
+
+    return (unsigned char)((lower_value + value) / 2);            // middle item or mean of 2 middle items
 
 }
 
 
 
+unsigned char find_median_i32(int32_t *dataSet, unsigned long data_length, unsigned char in_place,
+                              int32_t *median){
+    int32_t *work = dataSet;                                      // data set to reorder
+    unsigned long mid = (data_length - 1) / 2;                    // lower middle rank
+    int64_t middle;
+    unsigned long i;
+
+    *median = 0;
+    if (data_length ==  0) return 1;                              // empty set - median 0, not an error
+
+    if (!in_place){                                               // work on a copy
+        work = (int32_t *)reserve_words(data_length);
+        if (work == NULL) return 0;                               // no words for the copy
+        my_memcopy((uint8_t *)dataSet, (uint8_t *)work, data_length * sizeof(int32_t));
+    }
+
+    stats_select_i32(work, data_length, mid);
+    middle = work[mid];
+
+    if ((data_length % 2) == 0){
+        // upper middle item - the smallest item right of the lower middle
+        int32_t upper = work[mid+1];
+        for (i=mid+2;i<data_length;i++){
+            if (work[i] < upper) upper = work[i];
+        }
+        middle = (middle + (int64_t)upper) / 2;                   // mean of 2 middle items
+    }
+
+    if (!in_place) free_words((uint32_t *)work);
+    *median = (int32_t)middle;
+    return 1;
+}
+
+
+
+/*------------------- mms_scalar -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Minimum, maximum and sum kernel - one item at a time. Folds into the values
+ * already in result, so it also finishes the tail of the wide kernels.
+ *-------------------------------------------------------------------------------*/
+static void mms_scalar(const unsigned char *dataSet, unsigned long data_length,
+                       stats_minmaxsum_t *result){
+    unsigned char minimum = result->minimum;
+    unsigned char maximum = result->maximum;
+    unsigned long long dataSum = 0;
+    unsigned long i;
+
+    for (i=0;i<data_length;i++){
+        if (dataSet[i] < minimum) minimum = dataSet[i];
+        if (dataSet[i] > maximum) maximum = dataSet[i];
+        dataSum += dataSet[i];
+    }
+    result->minimum = minimum;
+    result->maximum = maximum;
+    result->sum    += dataSum;
+}
+
+
+
+/*------------------- mms_fold_lanes ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Folds the per lane minimum / maximum of a wide kernel into result.
+ *-------------------------------------------------------------------------------*/
+static void mms_fold_lanes(const uint8_t *min_lanes, const uint8_t *max_lanes,
+                           unsigned long lane_count, stats_minmaxsum_t *result){
+    unsigned long i;
+
+    for (i=0;i<lane_count;i++){
+        if (min_lanes[i] < result->minimum) result->minimum = min_lanes[i];
+        if (max_lanes[i] > result->maximum) result->maximum = max_lanes[i];
+    }
+}
+
+
+
+#if defined (STATS_X86_KERNELS)
+/*------------------- mms_sse2 ---------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * 16 items per step: pminub / pmaxub keep a running minimum / maximum per byte
+ * lane, psadbw against zero adds the 16 items into two 64-bit lanes.
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static void mms_sse2(const unsigned char *dataSet, unsigned long data_length,
+                     stats_minmaxsum_t *result){
+    __m128i vmin = _mm_set1_epi8((char)result->minimum);
+    __m128i vmax = _mm_set1_epi8((char)result->maximum);
+    __m128i vsum = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    uint8_t min_lanes[sizeof(__m128i)];
+    uint8_t max_lanes[sizeof(__m128i)];
+    uint64_t sums[2];
+    unsigned long i;
+
+    for (i=0;(i+sizeof(__m128i))<=data_length;i+=sizeof(__m128i)){
+        __m128i items = _mm_loadu_si128((const __m128i *)(dataSet + i));
+        vmin = _mm_min_epu8(vmin, items);
+        vmax = _mm_max_epu8(vmax, items);
+        vsum = _mm_add_epi64(vsum, _mm_sad_epu8(items, zero));
+    }
+
+    // reduce the lanes
+    _mm_storeu_si128((__m128i *)sums, vsum);
+    result->sum += sums[0] + sums[1];
+    _mm_storeu_si128((__m128i *)min_lanes, vmin);
+    _mm_storeu_si128((__m128i *)max_lanes, vmax);
+    mms_fold_lanes(min_lanes, max_lanes, sizeof(__m128i), result);
+
+    mms_scalar(dataSet + i, data_length - i, result);    // tail
+}
+
+
+
+/*------------------- mms_avx2 ---------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Same as mms_sse2 with 32 items per step (vpminub / vpmaxub / vpsadbw).
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static void mms_avx2(const unsigned char *dataSet, unsigned long data_length,
+                     stats_minmaxsum_t *result){
+    __m256i vmin = _mm256_set1_epi8((char)result->minimum);
+    __m256i vmax = _mm256_set1_epi8((char)result->maximum);
+    __m256i vsum = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    uint8_t min_lanes[sizeof(__m256i)];
+    uint8_t max_lanes[sizeof(__m256i)];
+    uint64_t sums[4];
+    unsigned long i;
+
+    for (i=0;(i+sizeof(__m256i))<=data_length;i+=sizeof(__m256i)){
+        __m256i items = _mm256_loadu_si256((const __m256i *)(dataSet + i));
+        vmin = _mm256_min_epu8(vmin, items);
+        vmax = _mm256_max_epu8(vmax, items);
+        vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(items, zero));
+    }
+
+    // reduce the lanes
+    _mm256_storeu_si256((__m256i *)sums, vsum);
+    result->sum += sums[0] + sums[1] + sums[2] + sums[3];
+    _mm256_storeu_si256((__m256i *)min_lanes, vmin);
+    _mm256_storeu_si256((__m256i *)max_lanes, vmax);
+    mms_fold_lanes(min_lanes, max_lanes, sizeof(__m256i), result);
+
+    mms_scalar(dataSet + i, data_length - i, result);    // tail
+}
+
+
+
+/*------------------- mms_avx512 -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Same as mms_sse2 with 64 items per step (AVX-512BW vpminub / vpmaxub / vpsadbw).
+ *-------------------------------------------------------------------------------*/
+__attribute__((target("avx512f,avx512bw")))
+static void mms_avx512(const unsigned char *dataSet, unsigned long data_length,
+                       stats_minmaxsum_t *result){
+    __m512i vmin = _mm512_set1_epi8((char)result->minimum);
+    __m512i vmax = _mm512_set1_epi8((char)result->maximum);
+    __m512i vsum = _mm512_setzero_si512();
+    const __m512i zero = _mm512_setzero_si512();
+    uint8_t min_lanes[sizeof(__m512i)];
+    uint8_t max_lanes[sizeof(__m512i)];
+    unsigned long i;
+
+    for (i=0;(i+sizeof(__m512i))<=data_length;i+=sizeof(__m512i)){
+        __m512i items = _mm512_loadu_si512((const void *)(dataSet + i));
+        vmin = _mm512_min_epu8(vmin, items);
+        vmax = _mm512_max_epu8(vmax, items);
+        vsum = _mm512_add_epi64(vsum, _mm512_sad_epu8(items, zero));
+    }
+
+    // reduce the lanes
+    result->sum += (uint64_t)_mm512_reduce_add_epi64(vsum);
+    _mm512_storeu_si512((void *)min_lanes, vmin);
+    _mm512_storeu_si512((void *)max_lanes, vmax);
+    mms_fold_lanes(min_lanes, max_lanes, sizeof(__m512i), result);
+
+    mms_scalar(dataSet + i, data_length - i, result);    // tail
+}
+#endif
+
+
+
+#if defined (MSP432)
+/*------------------- mms_msp432 -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * 4 items (one word) per step with the Cortex-M4 SIMD instructions:
+ *   __USUB8 sets the GE flag of each byte lane where a >= b, __SEL then picks the
+ *   larger / smaller byte of each lane (running maximum / minimum)
+ *   __USADA8 against zero adds the 4 items to a 32-bit total, which is moved to
+ *   the 64-bit sum before it can overflow
+ *-------------------------------------------------------------------------------*/
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) stats_uword32_t;
+
+#define MMS_WORDS_PER_BLOCK  (1UL << 22)       // 4 * 255 * 2^22 < 2^32
+
+static void mms_msp432(const unsigned char *dataSet, unsigned long data_length,
+                       stats_minmaxsum_t *result){
+    uint32_t wmin = 0x01010101UL * result->minimum;
+    uint32_t wmax = 0x01010101UL * result->maximum;
+    unsigned long words = data_length / sizeof(uint32_t);
+    unsigned long i = 0;
+    uint8_t min_lanes[sizeof(uint32_t)];
+    uint8_t max_lanes[sizeof(uint32_t)];
+
+    while (words != 0){
+        unsigned long block = (words < MMS_WORDS_PER_BLOCK) ? words : MMS_WORDS_PER_BLOCK;
+        uint32_t block_sum = 0;
+        words -= block;
+        while (block--){
+            uint32_t items = *((const stats_uword32_t *)(dataSet + i));
+            __USUB8(items, wmin);
+            wmin = __SEL(wmin, items);           // GE: items >= wmin -> keep wmin
+            __USUB8(items, wmax);
+            wmax = __SEL(items, wmax);           // GE: items >= wmax -> take items
+            block_sum = __USADA8(items, 0, block_sum);
+            i += sizeof(uint32_t);
+        }
+        result->sum += block_sum;
+    }
+
+    // reduce the lanes
+    *((stats_uword32_t *)min_lanes) = wmin;
+    *((stats_uword32_t *)max_lanes) = wmax;
+    mms_fold_lanes(min_lanes, max_lanes, sizeof(uint32_t), result);
+
+    mms_scalar(dataSet + i, data_length - i, result);    // tail
+}
+#endif
+
+
+
+/*------------------- mms_kernel -------------------------------------------------*
+ *
+ * Kernel used by find_min_max_sum. On x86 HOST builds mms_bind picks the widest
+ * kernel the CPU supports at load time (cpu_dispatch.h).
+ *-------------------------------------------------------------------------------*/
+typedef void (*mms_kernel_fn)(const unsigned char *, unsigned long, stats_minmaxsum_t *);
+
+#if defined (STATS_X86_KERNELS)
+static mms_kernel_fn mms_kernel = mms_scalar;
+
+static void mms_bind(cpu_isa_t isa){
+    mms_kernel = (isa >= CPU_ISA_AVX512) ? mms_avx512 :
+                 (isa >= CPU_ISA_AVX2)   ? mms_avx2   :
+                 (isa >= CPU_ISA_SSE2)   ? mms_sse2   : mms_scalar;
+}
+
+__attribute__((constructor))
+static void mms_dispatch_init(void){
+    cpu_dispatch_register(mms_bind);                    // before main
+}
+#elif defined (MSP432)
+static mms_kernel_fn mms_kernel = mms_msp432;
+#else
+static mms_kernel_fn mms_kernel = mms_scalar;
+#endif
+
+
+
+void find_min_max_sum(const unsigned char *dataSet, unsigned long data_length,
+                      stats_minmaxsum_t *result){
+    result->minimum = 0xFF;                       // identity of minimum
+    result->maximum = 0x00;                       // identity of maximum
+    result->sum     = 0;
+
+    if (data_length == 0){                        // nothing to scan
+        result->minimum = 0;
+        return;
+    }
+    mms_kernel(dataSet, data_length, result);
+}
+
 
 
 unsigned long find_mean(unsigned char *dataSet, unsigned long data_length){
-    unsigned long dataSum =0;
+    stats_minmaxsum_t result;
 
     if (data_length ==  0) return 0;              // check that data length is not zero
 
-    for (int i=0;i<data_length;i++){              // add all data values in array
-        dataSum += (unsigned long)(*(dataSet++));
-    }
+    find_min_max_sum(dataSet, data_length, &result);   // add all data values in array
 
-    return dataSum/data_length;                   // return average (mean)
+    return (unsigned long)(result.sum/data_length);    // return average (mean)
     
 }
 
 
 
 unsigned char find_maximum(unsigned char *dataSet, unsigned long data_length){
-    sort_array(dataSet, data_length);    // Sort the dataset from largest to smallest
-    
-    return dataSet[0];                   // return the largest data value - first item in array 
+    stats_minmaxsum_t result;
+
+    find_min_max_sum(dataSet, data_length, &result);   // data set is not sorted
+
+    return result.maximum;               // return the largest data value
 
 
 }
@@ -127,37 +805,58 @@ unsigned char find_maximum(unsigned char *dataSet, unsigned long data_length){
 
 
 unsigned char find_minimum(unsigned char *dataSet, unsigned long data_length){
-    sort_array(dataSet, data_length);    // Sort the dataset from largest to smallest
-    
-    return dataSet[data_length-1];       // return the smallest data value - last item in array 
+    stats_minmaxsum_t result;
+
+    find_min_max_sum(dataSet, data_length, &result);   // data set is not sorted
+
+    return result.minimum;               // return the smallest data value
 
 }
 
 
 
-void sort_array(unsigned char *dataSet, unsigned long data_length){
-    int x, y;
+/*------------------- insertion_sort_desc ----------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Insertion sort - largest to smallest. Used by sort_array for small data sets
+ * where clearing and scanning the 256 counting sort buckets costs more than
+ * the sort itself.
+ *-------------------------------------------------------------------------------*/
+static void insertion_sort_desc(unsigned char *dataSet, unsigned long data_length){
+    unsigned long x, y;
     unsigned char temp;
-    
-    // Bubble sorting - largest to smallest
-    for (x=0;x<data_length;x++){
-
-        for (y=0;y<(data_length-1);y++){
-            
-            if (dataSet[y] < dataSet[y+1]){ // compare values and swap if need be
-                temp = dataSet[y];          // assign smaller value to temp variable
-                dataSet[y] = dataSet[y+1];  // perform swap - move larger value to the left
-                dataSet[y+1] = temp;        // perform swap - move smaller value to the right
-            }
+
+    for (x=1;x<data_length;x++){
+        temp = dataSet[x];                          // item to insert
+        y = x;
+        while ((y > 0) && (dataSet[y-1] < temp)){   // shift smaller values to the right
+            dataSet[y] = dataSet[y-1];
+            y--;
         }
+        dataSet[y] = temp;
     }
-    
-    // print data set to screen
-    // print_array(dataSet, data_length);
-
 }
 
 
 
+void sort_array(unsigned char *dataSet, unsigned long data_length){
+    unsigned long count[STATS_BUCKETS] = {0};      // number of times each value occurs
+    unsigned long i;
+    int value;
 
+    if (data_length <= STATS_SMALL_SORT_LENGTH){
+        insertion_sort_desc(dataSet, data_length);
+        return;
+    }
 
+    // Counting sort - largest to smallest
+    for (i=0;i<data_length;i++){
+        count[dataSet[i]]++;                        // histogram of the data values
+    }
+    for (value=(STATS_BUCKETS-1);value>=0;value--){
+        // write each value count times, largest value first
+        my_memset(dataSet, (size_t)count[value], (uint8_t)value);
+        dataSet += count[value];
+    }
+}
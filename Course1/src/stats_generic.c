@@ -0,0 +1,422 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <stats_generic.c>
+ * @brief  <Statistics for 8/16/32-bit integer and floating point data>
+ *
+ * <This file contains the per type statistics and sort functions. The functions
+ *  of the wide types are written once as macros (STATS_GENERIC_SELECT,
+ *  STATS_GENERIC_WIDE, STATS_GENERIC_RADIX) and expanded for each type; the 8
+ *  and 16-bit statistics have their own histogram based code.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+
+
+
+#include "stats_generic.h"
+#include "memory.h"
+
+#define STATS_KEY16_SIGNED    (0x8000u)        // flips int16 into unsigned order
+#define STATS_KEY16_UNSIGNED  (0x0000u)
+
+
+
+/*------------------- STATS_GENERIC_SELECT ----------------------------------------*
+ *
+ * Defines stats_select_<SFX> for items of type T, with its private helpers
+ * select_swap_<SFX> (swap 2 items) and heap_select_<SFX> (heap sort, the
+ * bounded fallback once partitioning stops shrinking the range).
+ *-------------------------------------------------------------------------------*/
+#define STATS_GENERIC_SELECT(T, SFX)                                            \
+static void select_swap_##SFX(T *a, T *b){                                      \
+    T temp = *a;                                                                \
+    *a = *b;                                                                    \
+    *b = temp;                                                                  \
+}                                                                               \
+                                                                                \
+static void heap_select_##SFX(T *dataSet, unsigned long data_length){           \
+    unsigned long start, end, root, child;                                      \
+                                                                                \
+    if (data_length < 2) return;                                                \
+                                                                                \
+    /* build a max heap, then move the largest item to the end one at a time */ \
+    for (start=data_length/2;start-->0;){                                       \
+        for (root=start;(child=(2*root)+1)<data_length;root=child){             \
+            if (((child+1) < data_length) && (dataSet[child] < dataSet[child+1])) child++; \
+            if (dataSet[root] >= dataSet[child]) break;                         \
+            select_swap_##SFX(&dataSet[root], &dataSet[child]);                 \
+        }                                                                       \
+    }                                                                           \
+    for (end=data_length-1;end>0;end--){                                        \
+        select_swap_##SFX(&dataSet[0], &dataSet[end]);                          \
+        for (root=0;(child=(2*root)+1)<end;root=child){                         \
+            if (((child+1) < end) && (dataSet[child] < dataSet[child+1])) child++; \
+            if (dataSet[root] >= dataSet[child]) break;                         \
+            select_swap_##SFX(&dataSet[root], &dataSet[child]);                 \
+        }                                                                       \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+void stats_select_##SFX(T *dataSet, unsigned long data_length, unsigned long rank){ \
+    unsigned long lo = 0, hi = data_length;         /* active range [lo, hi) */ \
+    unsigned int depth = 0;                                                     \
+    unsigned long n;                                                            \
+                                                                                \
+    for (n=data_length;n>1;n>>=1) depth += 2;       /* 2 * log2(n) */           \
+                                                                                \
+    while ((hi - lo) > STATS_SMALL_SORT_LENGTH){                                \
+        unsigned long mid = lo + ((hi - lo) / 2);                               \
+        unsigned long i, j;                                                     \
+        T pivot;                                                                \
+                                                                                \
+        if (depth-- == 0){                          /* bad pivots */            \
+            heap_select_##SFX(dataSet + lo, hi - lo);                           \
+            return;                                                             \
+        }                                                                       \
+                                                                                \
+        /* median of three -> dataSet[mid], dataSet[lo] <= pivot <= dataSet[hi-1] */ \
+        if (dataSet[mid]  < dataSet[lo])  select_swap_##SFX(&dataSet[mid],  &dataSet[lo]);  \
+        if (dataSet[hi-1] < dataSet[lo])  select_swap_##SFX(&dataSet[hi-1], &dataSet[lo]);  \
+        if (dataSet[hi-1] < dataSet[mid]) select_swap_##SFX(&dataSet[hi-1], &dataSet[mid]); \
+        pivot = dataSet[mid];                                                   \
+                                                                                \
+        /* Hoare partition of [lo, hi) */                                       \
+        i = lo;                                                                 \
+        j = hi - 1;                                                             \
+        for (;;){                                                               \
+            while (dataSet[i] < pivot) i++;                                     \
+            while (dataSet[j] > pivot) j--;                                     \
+            if (i >= j) break;                                                  \
+            select_swap_##SFX(&dataSet[i], &dataSet[j]);                        \
+            i++;                                                                \
+            j--;                                                                \
+        }                                                                       \
+                                                                                \
+        /* [lo, j] <= pivot <= [j+1, hi) - keep the side holding rank */        \
+        if (rank <= j){                                                         \
+            hi = j + 1;                                                         \
+        }else{                                                                  \
+            lo = j + 1;                                                         \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    /* short range - insertion sort it */                                       \
+    for (n=lo+1;n<hi;n++){                                                      \
+        T item = dataSet[n];                                                    \
+        unsigned long y = n;                                                    \
+        while ((y > lo) && (dataSet[y-1] > item)){                              \
+            dataSet[y] = dataSet[y-1];                                          \
+            y--;                                                                \
+        }                                                                       \
+        dataSet[y] = item;                                                      \
+    }                                                                           \
+}
+
+
+
+/*------------------- STATS_GENERIC_WIDE ------------------------------------------*
+ *
+ * Defines stats_compute_<SFX> for items of type T, summed in type ACC.
+ * Pass 1: minimum, maximum, sum. Pass 2: squared deviations from the mean.
+ * Median: stats_select_<SFX> on a copy in reserve_words; for an even count the
+ * upper middle item is the smallest item right of the lower middle.
+ *-------------------------------------------------------------------------------*/
+#define STATS_GENERIC_WIDE(T, SFX, ACC)                                         \
+unsigned char stats_compute_##SFX(const T *dataSet, unsigned long data_length,  \
+                                  stats_generic_result_t *result){              \
+    unsigned long mid = (data_length - 1) / 2;      /* lower middle rank */     \
+    unsigned long i;                                                            \
+    T minimum, maximum;                                                         \
+    ACC sum = 0;                                                                \
+    double m2 = 0.0;                                                            \
+    T *work;                                                                    \
+                                                                                \
+    stats_generic_empty(result, data_length);                                  \
+    if (data_length == 0) return 1;                                             \
+                                                                                \
+    minimum = dataSet[0];                                                       \
+    maximum = dataSet[0];                                                       \
+    for (i=0;i<data_length;i++){                                                \
+        T item = dataSet[i];                                                    \
+        if (item < minimum) minimum = item;                                     \
+        if (item > maximum) maximum = item;                                     \
+        sum += item;                                                            \
+    }                                                                           \
+    result->sum     = (double)sum;                                              \
+    result->minimum = (double)minimum;                                          \
+    result->maximum = (double)maximum;                                          \
+    result->mean    = (double)sum / (double)data_length;                        \
+                                                                                \
+    for (i=0;i<data_length;i++){                                                \
+        double delta = (double)dataSet[i] - result->mean;                       \
+        m2 += delta * delta;                                                    \
+    }                                                                           \
+    result->variance = m2 / (double)data_length;                                \
+                                                                                \
+    work = (T *)reserve_words(((data_length * sizeof(T)) + 3) / 4);             \
+    if (work == NULL) return 0;                                                 \
+    my_memcopy((uint8_t *)dataSet, (uint8_t *)work, data_length * sizeof(T));   \
+    stats_select_##SFX(work, data_length, mid);                                 \
+    result->median = (double)work[mid];                                         \
+    if ((data_length % 2) == 0){                                                \
+        T upper = work[mid+1];                                                  \
+        for (i=mid+2;i<data_length;i++){                                        \
+            if (work[i] < upper) upper = work[i];                               \
+        }                                                                       \
+        result->median = (result->median + (double)upper) / 2.0;                \
+    }                                                                           \
+    free_words((uint32_t *)work);                                               \
+    return 1;                                                                   \
+}
+
+
+
+/*------------------- stats_generic_empty -----------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Sets count and zeroes all other statistics (the result of an empty data set).
+ *-------------------------------------------------------------------------------*/
+static void stats_generic_empty(stats_generic_result_t *result, unsigned long data_length){
+    result->count    = data_length;
+    result->sum      = 0.0;
+    result->minimum  = 0.0;
+    result->maximum  = 0.0;
+    result->mean     = 0.0;
+    result->median   = 0.0;
+    result->variance = 0.0;
+}
+
+
+
+/*------------------- stats_compute_key16 -----------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * stats_compute for 16-bit items. Each item is read as an unsigned key
+ * (item ^ flip) which orders like the item; the item value is key - flip.
+ * Pass 1 takes minimum, maximum, sum and a histogram of the key high bytes,
+ * which tells the high byte of the middle item(s). Pass 2 takes the squared
+ * deviations and a histogram of the low bytes of the keys in the middle
+ * high byte bucket(s). No copy, 3 KB of histograms on the stack.
+ *-------------------------------------------------------------------------------*/
+static void stats_compute_key16(const uint16_t *dataSet, unsigned long data_length,
+                                uint16_t flip, stats_generic_result_t *result){
+    unsigned long high[STATS_BUCKETS];             // items per key high byte
+    unsigned long low[2][STATS_BUCKETS];           // items per low byte, middle bucket(s)
+    unsigned long rank[2];                         // lower and upper middle rank
+    unsigned long below[2];                        // items in high buckets below the middle one
+    unsigned int bucket[2];                        // high byte of the middle item(s)
+    unsigned int key_min = 0xFFFF, key_max = 0;
+    long long sum = 0;
+    double m2 = 0.0;
+    double median[2];
+    unsigned long i, seen;
+    unsigned int b, m;
+
+    stats_generic_empty(result, data_length);
+    if (data_length == 0) return;
+
+    my_memzero((uint8_t *)high, sizeof(high));
+    my_memzero((uint8_t *)low, sizeof(low));
+
+    for (i=0;i<data_length;i++){
+        unsigned int key = (unsigned int)(dataSet[i] ^ flip);
+        if (key < key_min) key_min = key;
+        if (key > key_max) key_max = key;
+        sum += key;
+        high[key >> 8]++;
+    }
+    sum -= (long long)flip * (long long)data_length;             // keys -> item values
+    result->sum     = (double)sum;
+    result->minimum = (double)((long)key_min - (long)flip);
+    result->maximum = (double)((long)key_max - (long)flip);
+    result->mean    = (double)sum / (double)data_length;
+
+    // high byte bucket and items below it for both middle ranks
+    rank[0] = (data_length - 1) / 2;
+    rank[1] = data_length / 2;
+    for (m=0;m<2;m++){
+        seen = 0;
+        for (b=key_min>>8;(seen + high[b]) <= rank[m];b++) seen += high[b];
+        bucket[m] = b;
+        below[m]  = seen;
+    }
+
+    for (i=0;i<data_length;i++){
+        unsigned int key = (unsigned int)(dataSet[i] ^ flip);
+        double delta = ((double)((long)key - (long)flip)) - result->mean;
+        m2 += delta * delta;
+        if ((key >> 8) == bucket[0]) low[0][key & 0xFF]++;
+        if ((key >> 8) == bucket[1]) low[1][key & 0xFF]++;
+    }
+    result->variance = m2 / (double)data_length;
+
+    for (m=0;m<2;m++){
+        seen = below[m];
+        for (b=0;(seen + low[m][b]) <= rank[m];b++) seen += low[m][b];
+        median[m] = (double)((long)((bucket[m] << 8) | b) - (long)flip);
+    }
+    result->median = (median[0] + median[1]) / 2.0;
+}
+
+
+
+/*------------------- STATS_GENERIC_RADIX -----------------------------------------*
+ *
+ * Defines stats_sort_<SFX> for items of type T with unsigned keys of type KT
+ * made by KEY (order preserving), using BITS-bit digits. All digit counts are
+ * taken in one read of the data set; each pass turns one digit's counts into
+ * start offsets and scatters src into dst, then src and dst swap roles.
+ *-------------------------------------------------------------------------------*/
+#define STATS_GENERIC_RADIX(T, KT, SFX, KEY, BITS)                              \
+void stats_sort_##SFX(T *dataSet, T *scratch, unsigned long data_length,       \
+                      unsigned char descending){                                \
+    enum { PASSES = ((sizeof(KT) * 8) + (BITS) - 1) / (BITS),                   \
+           DIGITS = 1 << (BITS) };                                              \
+    uint32_t counts[PASSES][DIGITS];                                            \
+    KT flip = descending ? (KT)~(KT)0 : (KT)0;      /* descending - invert */   \
+    T *src = dataSet;                                                           \
+    T *dst = scratch;                                                           \
+    unsigned long i;                                                            \
+    unsigned int pass;                                                          \
+                                                                                \
+    if (data_length < 2) return;                                                \
+                                                                                \
+    my_memzero((uint8_t *)counts, sizeof(counts));                              \
+    for (i=0;i<data_length;i++){                                                \
+        KT key = KEY(dataSet[i]) ^ flip;                                        \
+        for (pass=0;pass<PASSES;pass++){                                        \
+            counts[pass][(key >> (pass * (BITS))) & (DIGITS - 1)]++;            \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    for (pass=0;pass<PASSES;pass++){                                            \
+        uint32_t *offset = counts[pass];                                        \
+        unsigned int shift = pass * (BITS);                                     \
+        uint32_t start = 0;                                                     \
+        T *temp;                                                                \
+        unsigned int d;                                                         \
+                                                                                \
+        /* all keys share this digit - the pass would not move anything */      \
+        if (offset[((KEY(src[0]) ^ flip) >> shift) & (DIGITS - 1)] == data_length) continue; \
+                                                                                \
+        for (d=0;d<DIGITS;d++){                     /* counts -> start offsets */ \
+            uint32_t count = offset[d];                                         \
+            offset[d] = start;                                                  \
+            start += count;                                                     \
+        }                                                                       \
+        for (i=0;i<data_length;i++){                                            \
+            KT key = KEY(src[i]) ^ flip;                                        \
+            dst[offset[(key >> shift) & (DIGITS - 1)]++] = src[i];              \
+        }                                                                       \
+        temp = src;                                                             \
+        src  = dst;                                                             \
+        dst  = temp;                                                            \
+    }                                                                           \
+                                                                                \
+    if (src != dataSet){                            /* odd no of passes made */ \
+        my_memcopy((uint8_t *)src, (uint8_t *)dataSet, data_length * sizeof(T)); \
+    }                                                                           \
+}
+
+
+
+/*------------------- radix_key_* -------------------------------------------------*
+ *
+ * These functions are private - not visible to public - not declared in header file
+ *
+ * Unsigned keys which sort like the items: unsigned as is, signed with the
+ * sign bit flipped, floats with all bits flipped when negative (larger
+ * magnitude - smaller item) and the sign bit set when positive.
+ *-------------------------------------------------------------------------------*/
+static uint16_t radix_key_u16(uint16_t item){ return item; }
+static uint16_t radix_key_i16(int16_t item){ return (uint16_t)((uint16_t)item ^ 0x8000u); }
+static uint32_t radix_key_u32(uint32_t item){ return item; }
+static uint32_t radix_key_i32(int32_t item){ return (uint32_t)item ^ 0x80000000UL; }
+static uint64_t radix_key_u64(uint64_t item){ return item; }
+static uint64_t radix_key_i64(int64_t item){ return (uint64_t)item ^ 0x8000000000000000ULL; }
+
+static uint32_t radix_key_f32(float item){
+    union { float f; uint32_t u; } bits;
+    bits.f = item;
+    return (bits.u & 0x80000000UL) ? ~bits.u : (bits.u | 0x80000000UL);
+}
+
+static uint64_t radix_key_f64(double item){
+    union { double f; uint64_t u; } bits;
+    bits.f = item;
+    return (bits.u & 0x8000000000000000ULL) ? ~bits.u : (bits.u | 0x8000000000000000ULL);
+}
+
+
+
+STATS_GENERIC_SELECT(uint8_t,  u8)
+STATS_GENERIC_SELECT(int16_t,  i16)
+STATS_GENERIC_SELECT(uint16_t, u16)
+STATS_GENERIC_SELECT(int32_t,  i32)
+STATS_GENERIC_SELECT(float,    f32)
+STATS_GENERIC_SELECT(double,   f64)
+
+STATS_GENERIC_WIDE(int32_t, i32, int64_t)
+STATS_GENERIC_WIDE(float,   f32, double)
+STATS_GENERIC_WIDE(double,  f64, double)
+
+STATS_GENERIC_RADIX(uint16_t, uint16_t, u16, radix_key_u16, 8)
+STATS_GENERIC_RADIX(int16_t,  uint16_t, i16, radix_key_i16, 8)
+STATS_GENERIC_RADIX(uint32_t, uint32_t, u32, radix_key_u32, STATS_RADIX_BITS)
+STATS_GENERIC_RADIX(int32_t,  uint32_t, i32, radix_key_i32, STATS_RADIX_BITS)
+STATS_GENERIC_RADIX(uint64_t, uint64_t, u64, radix_key_u64, STATS_RADIX_BITS)
+STATS_GENERIC_RADIX(int64_t,  uint64_t, i64, radix_key_i64, STATS_RADIX_BITS)
+STATS_GENERIC_RADIX(float,    uint32_t, f32, radix_key_f32, STATS_RADIX_BITS)
+STATS_GENERIC_RADIX(double,   uint64_t, f64, radix_key_f64, STATS_RADIX_BITS)
+
+
+
+unsigned char stats_compute_u8(const uint8_t *dataSet, unsigned long data_length,
+                               stats_generic_result_t *result){
+    stats_result_t bytes;
+
+    compute_statistics(dataSet, data_length, &bytes);           // one pass, histogram
+    stats_generic_empty(result, data_length);
+    if (data_length == 0) return 1;
+
+    result->sum      = (double)bytes.sum;
+    result->minimum  = (double)bytes.minimum;
+    result->maximum  = (double)bytes.maximum;
+    result->mean     = (double)bytes.sum / (double)data_length;
+    result->variance = bytes.variance;
+    // exact mean of the 2 middle items (bytes.median is rounded down)
+    result->median   = ((double)stats_value_at_rank(&bytes, (data_length - 1) / 2) +
+                        (double)stats_value_at_rank(&bytes, data_length / 2)) / 2.0;
+    return 1;
+}
+
+
+
+unsigned char stats_compute_i16(const int16_t *dataSet, unsigned long data_length,
+                                stats_generic_result_t *result){
+    // int16_t may be read through its unsigned type
+    stats_compute_key16((const uint16_t *)dataSet, data_length, STATS_KEY16_SIGNED, result);
+    return 1;
+}
+
+
+
+unsigned char stats_compute_u16(const uint16_t *dataSet, unsigned long data_length,
+                                stats_generic_result_t *result){
+    stats_compute_key16(dataSet, data_length, STATS_KEY16_UNSIGNED, result);
+    return 1;
+}
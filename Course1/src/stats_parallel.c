@@ -0,0 +1,366 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <stats_parallel.c>
+ * @brief  <Multithreaded statistics definition>
+ *
+ * <This file contains the statistics and sort drivers for large data sets.
+ *  Statistics: chunks are handed out through a shared counter, each thread
+ *  keeps its own accumulator and the accumulators are merged pairwise (tree)
+ *  once all threads are done. Sort: merge sort as tasks of a task_pool_t.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#if defined (HOST)
+    #define _POSIX_C_SOURCE 200112L            // posix_memalign
+    #define STATS_PARALLEL_THREADS             // task pool threads available
+#endif
+
+#include <stdlib.h>
+#include "stats_parallel.h"
+#include "stats_generic.h"
+#include "memory.h"
+#include "platform.h"
+
+#define STATS_PARALLEL_ALIGN  (64)             // cache line - chunk & accumulator alignment
+
+#if defined (STATS_PARALLEL_THREADS)
+
+/* Work shared by all threads of one compute_statistics_parallel call */
+typedef struct {
+    const unsigned char *dataSet;
+    unsigned long       data_length;
+    unsigned long       chunk_length;          // items per chunk
+    unsigned long       chunk_count;
+    unsigned long       next_chunk;            // next chunk to hand out (atomic)
+    stats_acc_t         *partials;             // one accumulator per thread
+} par_job_t;
+
+/* Arguments of one worker task */
+typedef struct {
+    par_job_t           *job;
+    unsigned int        index;                 // 0 .. workers-1, 0 is the calling thread
+} par_worker_t;
+
+
+
+/*------------------- par_worker --------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Task body: adds chunks to the own accumulator until none are left. The
+ * calling thread runs it as worker 0, so all chunks get done even if the
+ * pool threads are busy elsewhere.
+ *-------------------------------------------------------------------------------*/
+static void par_worker(void *arg){
+    par_worker_t *worker = (par_worker_t *)arg;
+    par_job_t *job = worker->job;
+    stats_acc_t *acc = &job->partials[worker->index];
+    unsigned long chunk;
+
+    stats_init(acc);
+    for (;;){
+        unsigned long start, length;
+
+        chunk = __atomic_fetch_add(&job->next_chunk, 1UL, __ATOMIC_RELAXED);
+        if (chunk >= job->chunk_count) break;
+
+        start  = chunk * job->chunk_length;
+        length = job->data_length - start;
+        if (length > job->chunk_length) length = job->chunk_length;
+        stats_push_block(acc, job->dataSet + start, length);
+    }
+}
+
+#endif /* STATS_PARALLEL_THREADS */
+
+
+
+void compute_statistics_parallel(const unsigned char *dataSet, unsigned long data_length,
+                                 stats_result_t *result, task_pool_t *pool){
+#if defined (STATS_PARALLEL_THREADS)
+    task_t tasks[STATS_PARALLEL_MAX_THREADS];
+    par_worker_t workers[STATS_PARALLEL_MAX_THREADS];
+    task_group_t group;
+    par_job_t job;
+    void *partials = NULL;
+    unsigned long chunk_length = STATS_PARALLEL_CHUNK_LENGTH;
+    unsigned int threads = task_pool_threads(pool);
+    unsigned int step;
+    unsigned int i;
+
+    if (threads > STATS_PARALLEL_MAX_THREADS) threads = STATS_PARALLEL_MAX_THREADS;
+    if (data_length < STATS_PARALLEL_MIN_LENGTH) threads = 1;   // short - not worth the wake ups
+
+    // fewer chunks than threads - split evenly, cache line multiples
+    if ((data_length / chunk_length) < threads){
+        chunk_length = (data_length + threads - 1) / threads;
+        chunk_length = (chunk_length + STATS_PARALLEL_ALIGN - 1) & ~(unsigned long)(STATS_PARALLEL_ALIGN - 1);
+        if (chunk_length == 0) chunk_length = STATS_PARALLEL_ALIGN;
+    }
+    job.chunk_count = (data_length + chunk_length - 1) / chunk_length;
+    if (threads > job.chunk_count) threads = (unsigned int)job.chunk_count;
+
+    if ((threads <= 1) ||
+        (posix_memalign(&partials, STATS_PARALLEL_ALIGN, threads * sizeof(stats_acc_t)) != 0)){
+        compute_statistics(dataSet, data_length, result);   // single threaded
+        return;
+    }
+
+    job.dataSet      = dataSet;
+    job.data_length  = data_length;
+    job.chunk_length = chunk_length;
+    job.next_chunk   = 0;
+    job.partials     = (stats_acc_t *)partials;
+
+    // one task per partial on the pool threads - no threads started per call;
+    // the calling thread is worker 0 and takes the chunks of tasks not yet picked up
+    task_group_init(&group);
+    for (i=1;i<threads;i++){
+        workers[i].job   = &job;
+        workers[i].index = i;
+        task_spawn(pool, &group, &tasks[i], par_worker, &workers[i]);
+    }
+    workers[0].job   = &job;
+    workers[0].index = 0;
+    par_worker(&workers[0]);
+    task_wait(pool, &group);
+
+    // tree merge - round step: i merges i + step for every i divisible by 2 * step
+    for (step=1;step<threads;step*=2){
+        for (i=0;(i+step)<threads;i+=2*step){
+            stats_merge(&job.partials[i], &job.partials[i+step]);
+        }
+    }
+
+    stats_snapshot(&job.partials[0], result);
+    free(partials);
+#else
+    (void)pool;                                              // no threads on this platform
+    compute_statistics(dataSet, data_length, result);
+#endif
+}
+
+
+
+void print_statistics_parallel(unsigned char *dataSet, unsigned long data_length,
+                               task_pool_t *pool){
+    stats_result_t result;
+
+    compute_statistics_parallel(dataSet, data_length, &result, pool);
+    print_statistics_result(dataSet, data_length, &result);
+}
+
+
+
+/* One merge path part: merge a and b into out */
+typedef struct {
+    const int32_t *a;
+    unsigned long a_length;
+    const int32_t *b;
+    unsigned long b_length;
+    int32_t       *out;
+    unsigned char descending;
+} psort_merge_t;
+
+/* One merge sort task: sort data, result in scratch if into_scratch */
+typedef struct {
+    task_pool_t   *pool;
+    int32_t       *data;
+    int32_t       *scratch;
+    unsigned long length;
+    unsigned long leaf_length;                 // radix sort pieces up to this length
+    unsigned char descending;
+    unsigned char into_scratch;
+} psort_job_t;
+
+
+
+/*------------------- psort_merge_task -------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Merges one part (task body). On equal items a goes first, so the merge is
+ * stable.
+ *-------------------------------------------------------------------------------*/
+static void psort_merge_task(void *arg){
+    const psort_merge_t *part = (const psort_merge_t *)arg;
+    const int32_t *a = part->a, *a_end = part->a + part->a_length;
+    const int32_t *b = part->b, *b_end = part->b + part->b_length;
+    int32_t *out = part->out;
+
+    // branch free - which side goes next is random for random data
+    if (part->descending){
+        while ((a < a_end) && (b < b_end)){
+            int32_t x = *a, y = *b;
+            int take_b = (y > x);
+            *out++ = take_b ? y : x;
+            a += !take_b;
+            b += take_b;
+        }
+    }else{
+        while ((a < a_end) && (b < b_end)){
+            int32_t x = *a, y = *b;
+            int take_b = (y < x);
+            *out++ = take_b ? y : x;
+            a += !take_b;
+            b += take_b;
+        }
+    }
+    while (a < a_end) *out++ = *a++;
+    while (b < b_end) *out++ = *b++;
+}
+
+
+
+/*------------------- psort_merge_path -------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Returns how many of the first diagonal merged items come from a (binary
+ * search along the cross diagonal of the merge matrix).
+ *-------------------------------------------------------------------------------*/
+static unsigned long psort_merge_path(const int32_t *a, unsigned long a_length,
+                                      const int32_t *b, unsigned long b_length,
+                                      unsigned long diagonal, unsigned char descending){
+    unsigned long lo = (diagonal > b_length) ? (diagonal - b_length) : 0;
+    unsigned long hi = (diagonal < a_length) ? diagonal : a_length;
+
+    while (lo < hi){
+        unsigned long mid = lo + ((hi - lo) / 2);
+        int32_t x = a[mid];
+        int32_t y = b[diagonal - mid - 1];
+        // a[mid] merges before b[diagonal - mid - 1] - it is among the first diagonal
+        if (descending ? (x >= y) : (x <= y)){
+            lo = mid + 1;
+        }else{
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+
+/*------------------- psort_merge ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Merges a and b into out, cut into parts of equal output size that run as
+ * tasks. Short merges run as one part.
+ *-------------------------------------------------------------------------------*/
+static void psort_merge(task_pool_t *pool, const int32_t *a, unsigned long a_length,
+                        const int32_t *b, unsigned long b_length, int32_t *out,
+                        unsigned char descending){
+    psort_merge_t parts[STATS_SORT_MAX_PARTS];
+    task_t tasks[STATS_SORT_MAX_PARTS];
+    task_group_t group;
+    unsigned long total = a_length + b_length;
+    unsigned long count = total / STATS_SORT_MERGE_GRAIN;
+    unsigned long limit = 4UL * task_pool_threads(pool);      // some spare parts to steal
+    unsigned long k, a_start = 0, diagonal = 0;
+
+    if (count > limit) count = limit;
+    if (count > STATS_SORT_MAX_PARTS) count = STATS_SORT_MAX_PARTS;
+    if (count < 1) count = 1;
+
+    task_group_init(&group);
+    for (k=0;k<count;k++){
+        unsigned long next = (k == (count - 1)) ? total : (((k + 1) * total) / count);
+        unsigned long a_next = psort_merge_path(a, a_length, b, b_length, next, descending);
+
+        parts[k].a          = a + a_start;
+        parts[k].a_length   = a_next - a_start;
+        parts[k].b          = b + (diagonal - a_start);
+        parts[k].b_length   = (next - a_next) - (diagonal - a_start);
+        parts[k].out        = out + diagonal;
+        parts[k].descending = descending;
+        if (k < (count - 1)){
+            task_spawn(pool, &group, &tasks[k], psort_merge_task, &parts[k]);
+        }
+        a_start  = a_next;
+        diagonal = next;
+    }
+    psort_merge_task(&parts[count - 1]);                      // last part on this thread
+    task_wait(pool, &group);
+}
+
+
+
+/*------------------- psort_task -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Merge sort task body. Leaves are radix sorted in place; larger pieces sort
+ * their halves into the other buffer (left half as a task) and merge them back.
+ *-------------------------------------------------------------------------------*/
+static void psort_task(void *arg){
+    const psort_job_t *job = (const psort_job_t *)arg;
+    psort_job_t halves[2];
+    task_t task;
+    task_group_t group;
+    unsigned long half = job->length / 2;
+    const int32_t *source;
+    int32_t *target;
+
+    if (job->length <= job->leaf_length){
+        stats_sort_i32(job->data, job->scratch, job->length, job->descending);
+        if (job->into_scratch){
+            my_memcopy((uint8_t *)job->data, (uint8_t *)job->scratch, job->length * sizeof(int32_t));
+        }
+        return;
+    }
+
+    halves[0]              = *job;
+    halves[0].length       = half;
+    halves[0].into_scratch = !job->into_scratch;
+    halves[1]              = halves[0];
+    halves[1].data         = job->data + half;
+    halves[1].scratch      = job->scratch + half;
+    halves[1].length       = job->length - half;
+
+    task_group_init(&group);
+    task_spawn(job->pool, &group, &task, psort_task, &halves[0]);
+    psort_task(&halves[1]);
+    task_wait(job->pool, &group);
+
+    source = job->into_scratch ? job->data : job->scratch;     // where the halves are
+    target = job->into_scratch ? job->scratch : job->data;
+    psort_merge(job->pool, source, half, source + half, job->length - half, target,
+                job->descending);
+}
+
+
+
+void sort_parallel_i32(int32_t *dataSet, int32_t *scratch, unsigned long data_length,
+                       unsigned char descending, task_pool_t *pool){
+    psort_job_t job;
+
+    if ((pool == NULL) || (data_length <= STATS_SORT_LEAF_LENGTH)){
+        stats_sort_i32(dataSet, scratch, data_length, descending);
+        return;
+    }
+
+    job.pool         = pool;
+    job.data         = dataSet;
+    job.scratch      = scratch;
+    job.length       = data_length;
+    // every merge level reads and writes all items - only split as far as
+    // needed for STATS_SORT_LEAVES_PER_THREAD leaves per thread to steal
+    job.leaf_length  = data_length / (STATS_SORT_LEAVES_PER_THREAD * task_pool_threads(pool));
+    if (job.leaf_length < STATS_SORT_LEAF_LENGTH) job.leaf_length = STATS_SORT_LEAF_LENGTH;
+    job.descending   = descending;
+    job.into_scratch = 0;
+    psort_task(&job);
+}
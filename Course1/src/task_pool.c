@@ -0,0 +1,387 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <task_pool.c>
+ * @brief  <Work stealing task pool definition>
+ *
+ * <This file contains the task pool. The per thread queues are fixed size
+ *  Chase-Lev deques (lock free: the owner works at the bottom, thieves take
+ *  from the top with a compare and swap). Threads with nothing to run or steal
+ *  yield for a while and then sleep until a task is queued.>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#if defined (HOST)
+    #define _POSIX_C_SOURCE 200112L            // posix_memalign, sysconf, sched_yield
+    #define TASK_POOL_THREADS                  // POSIX threads available
+#endif
+
+#include <stdlib.h>
+#include "task_pool.h"
+
+#if defined (TASK_POOL_THREADS)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
+
+#define TASK_IDLE_SPINS  (64)                  // empty steal rounds before sleeping
+
+
+
+/*------------------- task_run ---------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Runs a task and marks it finished in its group. The task memory may be gone
+ * once pending drops, so it is not touched after the decrement.
+ *-------------------------------------------------------------------------------*/
+static void task_run(task_t *task){
+    task_group_t *group = task->group;
+
+    task->fn(task->arg);
+    __atomic_sub_fetch(&group->pending, 1UL, __ATOMIC_RELEASE);
+}
+
+
+
+void task_group_init(task_group_t *group){
+    group->pending = 0;
+}
+
+
+
+#if defined (TASK_POOL_THREADS)
+
+/* Chase-Lev deque - bottom is owned by one thread, top is shared */
+typedef struct {
+    long   top __attribute__((aligned(64)));   // next task to steal
+    long   bottom __attribute__((aligned(64)));// next free slot of the owner
+    task_t *slots[TASK_DEQUE_SIZE];
+} task_deque_t;
+
+struct task_pool {
+    unsigned int    threads;                   // deques - workers + the outside thread
+    unsigned int    started;                   // workers running, handles[1 .. started]
+    task_deque_t    *deques;                   // [0] is the outside thread's
+    pthread_t       handles[TASK_POOL_MAX_THREADS];
+    unsigned long   queued;                    // tasks in all deques (atomic)
+    unsigned int    sleeping;                  // threads waiting on wake (atomic)
+    int             stop;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+};
+
+/* Arguments of one worker thread */
+typedef struct {
+    task_pool_t     *pool;
+    unsigned int    index;
+} task_worker_t;
+
+static __thread task_pool_t *current_pool;     // pool of this thread, NULL outside
+static __thread unsigned int current_index;    // its deque in that pool
+static __thread unsigned int current_seed;     // victim choice
+
+
+
+/*------------------- deque_push -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Owner only. Returns 0 if the deque is full.
+ *-------------------------------------------------------------------------------*/
+static int deque_push(task_deque_t *deque, task_t *task){
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+
+    if ((bottom - top) >= TASK_DEQUE_SIZE) return 0;
+    __atomic_store_n(&deque->slots[bottom & (TASK_DEQUE_SIZE - 1)], task, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+
+
+/*------------------- deque_take -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Owner only. Returns the newest task or NULL; races a thief for the last one.
+ *-------------------------------------------------------------------------------*/
+static task_t *deque_take(task_deque_t *deque){
+    long bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    long top;
+    task_t *task = NULL;
+
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+    if (top <= bottom){
+        task = __atomic_load_n(&deque->slots[bottom & (TASK_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+        if (top == bottom){                                // last task - thieves may want it too
+            if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+                task = NULL;
+            }
+            __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        }
+    }else{                                                 // empty
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+
+
+/*------------------- deque_steal ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Any thread. Returns the oldest task or NULL (empty or lost a race).
+ *-------------------------------------------------------------------------------*/
+static task_t *deque_steal(task_deque_t *deque){
+    long top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    long bottom;
+    task_t *task;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom) return NULL;
+
+    task = __atomic_load_n(&deque->slots[top & (TASK_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+        return NULL;
+    }
+    return task;
+}
+
+
+
+/*------------------- pool_index -------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Deque of the calling thread: its own for workers, 0 for the outside thread.
+ *-------------------------------------------------------------------------------*/
+static unsigned int pool_index(const task_pool_t *pool){
+    return (current_pool == pool) ? current_index : 0;
+}
+
+
+
+/*------------------- pool_find --------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Returns a task for thread index: its own newest, else the oldest of another
+ * thread starting at a random victim. NULL if none was found.
+ *-------------------------------------------------------------------------------*/
+static task_t *pool_find(task_pool_t *pool, unsigned int index){
+    task_t *task = deque_take(&pool->deques[index]);
+    unsigned int victim, i;
+
+    if (task == NULL){
+        current_seed = (current_seed * 1103515245U) + 12345U;
+        victim = (current_seed >> 16) % pool->threads;
+        for (i=0;(i<pool->threads) && (task == NULL);i++){
+            if (victim != index) task = deque_steal(&pool->deques[victim]);
+            if (++victim == pool->threads) victim = 0;
+        }
+    }
+    if (task != NULL) __atomic_sub_fetch(&pool->queued, 1UL, __ATOMIC_SEQ_CST);
+    return task;
+}
+
+
+
+/*------------------- pool_worker ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Worker thread body: run or steal tasks until the pool stops; sleep on wake
+ * after TASK_IDLE_SPINS empty rounds while no task is queued anywhere.
+ *-------------------------------------------------------------------------------*/
+static void *pool_worker(void *arg){
+    task_worker_t *worker = (task_worker_t *)arg;
+    task_pool_t *pool = worker->pool;
+    unsigned int idle = 0;
+
+    current_pool  = pool;
+    current_index = worker->index;
+    current_seed  = worker->index;
+    free(worker);
+
+    while (!__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)){
+        task_t *task = pool_find(pool, current_index);
+
+        if (task != NULL){
+            task_run(task);
+            idle = 0;
+        }else if (++idle < TASK_IDLE_SPINS){
+            sched_yield();
+        }else{
+            // sleeping is raised before queued is read - task_spawn raises queued
+            // before it reads sleeping, so one of the two sees the other
+            pthread_mutex_lock(&pool->lock);
+            __atomic_add_fetch(&pool->sleeping, 1U, __ATOMIC_SEQ_CST);
+            while ((__atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0) && !pool->stop){
+                pthread_cond_wait(&pool->wake, &pool->lock);
+            }
+            __atomic_sub_fetch(&pool->sleeping, 1U, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&pool->lock);
+            idle = 0;
+        }
+    }
+    return NULL;
+}
+
+#endif /* TASK_POOL_THREADS */
+
+
+
+task_pool_t *task_pool_create(unsigned int threads){
+#if defined (TASK_POOL_THREADS)
+    task_pool_t *pool;
+    void *deques = NULL;
+    unsigned int i;
+
+    if (threads == 0){
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus < 1) ? 1U : (unsigned int)cpus;
+    }
+    if (threads > TASK_POOL_MAX_THREADS) threads = TASK_POOL_MAX_THREADS;
+
+    pool = (task_pool_t *)malloc(sizeof(task_pool_t));
+    if (pool == NULL) return NULL;
+    if (posix_memalign(&deques, 64, threads * sizeof(task_deque_t)) != 0){
+        free(pool);
+        return NULL;
+    }
+
+    pool->threads  = threads;
+    pool->deques   = (task_deque_t *)deques;
+    pool->queued   = 0;
+    pool->sleeping = 0;
+    pool->stop     = 0;
+    for (i=0;i<threads;i++){
+        pool->deques[i].top    = 0;
+        pool->deques[i].bottom = 0;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (i=1;i<threads;i++){
+        task_worker_t *worker = (task_worker_t *)malloc(sizeof(task_worker_t));
+        if (worker == NULL) break;
+        worker->pool  = pool;
+        worker->index = i;
+        if (pthread_create(&pool->handles[i], NULL, pool_worker, worker) != 0){
+            free(worker);
+            break;
+        }
+    }
+    pool->started = i - 1;                                 // a failed start leaves its deque empty
+    return pool;
+#else
+    (void)threads;                                         // no threads on this platform
+    return NULL;
+#endif
+}
+
+
+
+void task_pool_destroy(task_pool_t *pool){
+#if defined (TASK_POOL_THREADS)
+    unsigned int i;
+
+    if (pool == NULL) return;
+    pthread_mutex_lock(&pool->lock);
+    __atomic_store_n(&pool->stop, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (i=1;i<=pool->started;i++) pthread_join(pool->handles[i], NULL);
+
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deques);
+    free(pool);
+#else
+    (void)pool;
+#endif
+}
+
+
+
+unsigned int task_pool_threads(const task_pool_t *pool){
+#if defined (TASK_POOL_THREADS)
+    return (pool == NULL) ? 1U : (pool->started + 1);
+#else
+    (void)pool;
+    return 1U;
+#endif
+}
+
+
+
+void task_spawn(task_pool_t *pool, task_group_t *group, task_t *task,
+                task_fn_t fn, void *arg){
+    task->fn    = fn;
+    task->arg   = arg;
+    task->group = group;
+    __atomic_add_fetch(&group->pending, 1UL, __ATOMIC_RELAXED);
+
+#if defined (TASK_POOL_THREADS)
+    if ((pool != NULL) && deque_push(&pool->deques[pool_index(pool)], task)){
+        __atomic_add_fetch(&pool->queued, 1UL, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&pool->sleeping, __ATOMIC_SEQ_CST) != 0){
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->wake);
+            pthread_mutex_unlock(&pool->lock);
+        }
+        return;
+    }
+#else
+    (void)pool;
+#endif
+    task_run(task);                                        // no pool or queue full
+}
+
+
+
+void task_wait(task_pool_t *pool, task_group_t *group){
+#if defined (TASK_POOL_THREADS)
+    unsigned int index;
+
+    if (pool != NULL){
+        index = pool_index(pool);
+        while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0){
+            task_t *task = pool_find(pool, index);
+            if (task != NULL){
+                task_run(task);
+            }else{
+                sched_yield();
+            }
+        }
+        return;
+    }
+#else
+    (void)pool;
+#endif
+    // without a pool every task ran in task_spawn - wait for the group anyway
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0){
+    }
+}
@@ -0,0 +1,308 @@
+/******************************************************************************
+ * Copyright (C) 2017 by Alex Fosdick - University of Colorado
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Alex Fosdick and the University of Colorado are not liable for any
+ * misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file   <trace.c>
+ * @brief  <Deferred binary trace log definition>
+ *
+ * <This file contains the trace ring buffer and its decoder. Writers claim a
+ *  slot by moving head on with a compare and swap (so a full ring is never
+ *  overwritten), fill it and publish it by storing its ticket + 1 in ready
+ *  (release). The single reader decodes slots in ticket order while ready
+ *  matches, then gives them back by moving tail on (release).>
+ *
+ *
+ * @author <Chiemezie Albert Udoh>
+ * @date   <15.08.2021>
+ *
+ */
+#if defined (HOST)
+    #define _POSIX_C_SOURCE 200112L            // nanosleep, sched_yield
+    #define TRACE_THREADS                      // POSIX threads available
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "trace.h"
+
+#if defined (TRACE_THREADS)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <time.h>
+#endif
+
+#if (TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) != 0
+#error "TRACE_RING_SIZE must be a power of 2"
+#endif
+
+#define TRACE_SPEC_SIZE  (24)                  // longest conversion spec, e.g. "%-08.3llx"
+
+/* One record - 64 bytes (a cache line) on 64-bit HOST, 32 bytes on MSP432 */
+typedef struct {
+    const trace_format_t *format;
+    unsigned long         ready;               // ticket + 1 once written (atomic)
+    trace_arg_t           args[TRACE_MAX_ARGS];
+} trace_record_t;
+
+#if defined (HOST)
+static trace_record_t trace_ring[TRACE_RING_SIZE] __attribute__((aligned(64)));
+static unsigned long  trace_head __attribute__((aligned(64))) = 0;  // next ticket to write
+static unsigned long  trace_tail __attribute__((aligned(64))) = 0;  // next ticket to decode
+#else
+static trace_record_t trace_ring[TRACE_RING_SIZE];
+static unsigned long  trace_head = 0;
+static unsigned long  trace_tail = 0;
+#endif
+static unsigned long  trace_lost = 0;          // records dropped (atomic)
+static unsigned long  trace_reported = 0;      // drops already reported by trace_flush
+static unsigned char  trace_reading = 0;       // a trace_flush runs (atomic flag)
+
+
+
+/*------------------- trace_stdout ----------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Default sink of the HOST build.
+ *-------------------------------------------------------------------------------*/
+#if defined (HOST)
+static void trace_stdout(const char *text, size_t length){
+    fwrite(text, 1, length, stdout);
+}
+static trace_sink_t trace_sink = trace_stdout;
+#else
+static trace_sink_t trace_sink = NULL;
+#endif
+
+
+
+void trace_write(const trace_format_t *format,
+                 trace_arg_t a0, trace_arg_t a1, trace_arg_t a2,
+                 trace_arg_t a3, trace_arg_t a4, trace_arg_t a5){
+    unsigned long head = __atomic_load_n(&trace_head, __ATOMIC_RELAXED);
+    trace_record_t *record;
+
+    do {
+        /* acquire - the reader is done with the slot before it is overwritten */
+        if ((head - __atomic_load_n(&trace_tail, __ATOMIC_ACQUIRE)) >= TRACE_RING_SIZE){
+            __atomic_add_fetch(&trace_lost, 1UL, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&trace_head, &head, head + 1, 1,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    record = &trace_ring[head & (TRACE_RING_SIZE - 1)];
+    record->format  = format;
+    record->args[0] = a0;
+    record->args[1] = a1;
+    record->args[2] = a2;
+    record->args[3] = a3;
+    record->args[4] = a4;
+    record->args[5] = a5;
+    __atomic_store_n(&record->ready, head + 1, __ATOMIC_RELEASE);
+}
+
+
+
+/*------------------- trace_spec ------------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Formats one conversion spec (e.g. "%-5lu") with its argument cast back to the
+ * type printf expects. Returns the snprintf result.
+ *-------------------------------------------------------------------------------*/
+static int trace_spec(const char *spec, char conversion, const char *modifier,
+                      trace_arg_t arg, char *text, size_t size){
+    unsigned char longs = (modifier[0] == 'l') + (modifier[1] == 'l');
+
+    switch (conversion){
+    case 'd': case 'i':
+        if (modifier[0] == 'z' || modifier[0] == 't') return snprintf(text, size, spec, (ptrdiff_t)arg);
+        if (modifier[0] == 'j') return snprintf(text, size, spec, (intmax_t)(intptr_t)arg);
+        if (longs == 2) return snprintf(text, size, spec, (long long)(intptr_t)arg);
+        if (longs == 1) return snprintf(text, size, spec, (long)(intptr_t)arg);
+        return snprintf(text, size, spec, (int)arg);
+    case 'u': case 'o': case 'x': case 'X':
+        if (modifier[0] == 'z' || modifier[0] == 't') return snprintf(text, size, spec, (size_t)arg);
+        if (modifier[0] == 'j') return snprintf(text, size, spec, (uintmax_t)arg);
+        if (longs == 2) return snprintf(text, size, spec, (unsigned long long)arg);
+        if (longs == 1) return snprintf(text, size, spec, (unsigned long)arg);
+        return snprintf(text, size, spec, (unsigned int)arg);
+    case 'c':
+        return snprintf(text, size, spec, (int)arg);
+    case 's':
+        return snprintf(text, size, spec, (arg != 0) ? (const char *)arg : "(null)");
+    case 'p':
+        return snprintf(text, size, spec, (void *)arg);
+    default:                                   // floating point, '*', unknown
+        return snprintf(text, size, "?");
+    }
+}
+
+
+
+size_t trace_format(const trace_format_t *format, const trace_arg_t *args,
+                    char *text, size_t size){
+    const char *f = format->format;
+    size_t length = 0;
+    unsigned int next = 0;
+
+    while ((*f != '\0') && (length < (size - 1))){
+        char spec[TRACE_SPEC_SIZE];
+        char modifier[3] = { 0, 0, 0 };
+        unsigned int s = 0, m = 0;
+        int written;
+
+        if (*f != '%'){
+            text[length++] = *f++;
+            continue;
+        }
+        spec[s++] = *f++;
+        while ((*f != '\0') && (strchr("-+ #0123456789.", *f) != NULL) && (s < (TRACE_SPEC_SIZE - 4))){
+            spec[s++] = *f++;
+        }
+        while ((*f != '\0') && (strchr("hlzjt", *f) != NULL) && (m < 2)){
+            modifier[m++] = *f;
+            spec[s++] = *f++;
+        }
+        if (*f == '\0') break;
+        if (*f == '%'){
+            text[length++] = '%';
+            f++;
+            continue;
+        }
+        spec[s++] = *f;
+        spec[s] = '\0';
+        written = trace_spec(spec, *f++, modifier, (next < TRACE_MAX_ARGS) ? args[next] : 0,
+                             text + length, size - length);
+        next++;
+        if (written < 0) continue;
+        length += ((size_t)written < (size - length)) ? (size_t)written : (size - 1 - length);
+    }
+    text[length] = '\0';
+    return length;
+}
+
+
+
+unsigned long trace_flush(void){
+    unsigned long decoded = 0;
+    unsigned long lost;
+    char text[TRACE_TEXT_SIZE];
+
+    while (__atomic_test_and_set(&trace_reading, __ATOMIC_ACQUIRE)){
+#if defined (TRACE_THREADS)
+        sched_yield();                         // the background decoder is flushing
+#endif
+    }
+
+    while (trace_sink != NULL){
+        unsigned long tail = trace_tail;       // only changed by the reader
+        trace_record_t *record = &trace_ring[tail & (TRACE_RING_SIZE - 1)];
+        trace_record_t copy;
+
+        if (__atomic_load_n(&record->ready, __ATOMIC_ACQUIRE) != (tail + 1)) break;
+        copy = *record;
+        __atomic_store_n(&trace_tail, tail + 1, __ATOMIC_RELEASE);
+
+        trace_sink(text, trace_format(copy.format, copy.args, text, sizeof(text)));
+        decoded++;
+    }
+
+    lost = __atomic_load_n(&trace_lost, __ATOMIC_RELAXED);
+    if ((trace_sink != NULL) && (lost != trace_reported)){
+        trace_sink(text, (size_t)snprintf(text, sizeof(text), "trace: %lu records dropped\n",
+                                          lost - trace_reported));
+        trace_reported = lost;
+    }
+
+    __atomic_clear(&trace_reading, __ATOMIC_RELEASE);
+    return decoded;
+}
+
+
+
+trace_sink_t trace_sink_install(trace_sink_t sink){
+    trace_sink_t previous = trace_sink;
+
+    trace_sink = sink;
+    return previous;
+}
+
+
+
+unsigned long trace_dropped(void){
+    return __atomic_load_n(&trace_lost, __ATOMIC_RELAXED);
+}
+
+
+
+#if defined (TRACE_THREADS)
+
+static pthread_t     trace_thread;
+static unsigned int  trace_period_ms = 0;
+static unsigned char trace_running = 0;        // background decoder started (atomic)
+
+/*------------------- trace_decoder ---------------------------------------------*
+ *
+ * This function is private - not visible to public - not declared in header file
+ *
+ * Background decoder thread - flushes every trace_period_ms until stopped.
+ *-------------------------------------------------------------------------------*/
+static void *trace_decoder(void *arg){
+    struct timespec period;
+
+    (void)arg;
+    period.tv_sec  = trace_period_ms / 1000U;
+    period.tv_nsec = (long)(trace_period_ms % 1000U) * 1000000L;
+    while (__atomic_load_n(&trace_running, __ATOMIC_ACQUIRE)){
+        trace_flush();
+        nanosleep(&period, NULL);
+    }
+    return NULL;
+}
+
+
+
+int trace_decoder_start(unsigned int period_ms){
+    if (trace_running) return 0;
+    trace_period_ms = period_ms;
+    trace_running = 1;
+    if (pthread_create(&trace_thread, NULL, trace_decoder, NULL) != 0){
+        trace_running = 0;
+        return 0;
+    }
+    return 1;
+}
+
+
+
+void trace_decoder_stop(void){
+    if (trace_running){
+        __atomic_store_n(&trace_running, 0, __ATOMIC_RELEASE);
+        pthread_join(trace_thread, NULL);
+    }
+    trace_flush();
+}
+
+#else
+
+int trace_decoder_start(unsigned int period_ms){
+    (void)period_ms;
+    return 0;
+}
+
+
+
+void trace_decoder_stop(void){
+    trace_flush();
+}
+
+#endif